@@ -0,0 +1,119 @@
+/**
+ @file wcetHarness.ino
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a
+
+ @brief Execution time harness - target backend
+
+ Runs the library's execution time harness (Wcet::runHarness) on target and prints the results
+ as CSV over the USB serial port.  Times are in CPU cycles.
+
+ Contention is from a Ticker ISR queueing reports and publishing the harness reporter's latest value and
+ a thread, at a higher priority than the harness, draining the report queue.
+ */
+#include <mbed.h>
+#include <daws.h>
+#include <dawsReporter.h>
+#include <dawsHeapGuard.h>
+#include <dawsWcet.h>
+
+#define LOAD_PERIOD_US 50   ///< contending ISR period
+
+/**
+ @brief Contending reporter
+
+ Makes reports from the Ticker ISR.
+ */
+class LoadReporter: public Reporter
+{
+public:
+    LoadReporter() : Reporter(WCET_REP)
+    {
+    }
+
+    ReporterType getType()
+    {
+        return(WCET_REP);
+    }
+};
+
+LoadReporter loadReporter;
+Reporter* harnessReporter;
+mbed::Ticker loadTicker;
+rtos::Thread consumer(osPriorityAboveNormal, 1024);
+volatile bool running = false;
+int loadCount = 0;
+
+/**
+ @brief Load ISR
+
+ @ingroup ISR
+ */
+void loadIsr()
+{
+    loadReporter.queueReport(SET_AUTO, loadCount);
+    harnessReporter->publishLatest(loadCount++);
+}
+
+/**
+ @brief Consumer thread
+
+ Drain the report queue while the load is running.  It waits in tryGetReport() while the queue
+ is empty so, although it runs above the harness, it does not starve it.
+ */
+void consume()
+{
+    report_t report;
+    while (true)
+    {
+        if (running)
+        {
+            Reporter::tryGetReport(&report, 1ms);  // blocks until a report or time out
+        }
+        else
+        {
+            rtos::ThisThread::sleep_for(10ms);
+        }
+    }
+}
+
+/**
+ @brief Contention control
+
+ @param rp - the harness reporter
+ @param start - true to start, false to stop
+ */
+void contention(Reporter* rp, bool start)
+{
+    if (start)
+    {
+        harnessReporter = rp;
+        running = true;
+        loadTicker.attach(loadIsr, std::chrono::microseconds(LOAD_PERIOD_US));
+    }
+    else
+    {
+        loadTicker.detach();
+        running = false;
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial)
+    {
+    }
+    consumer.start(consume);
+    HeapGuard::initComplete();  // sketch objects made
+    if (Wcet::runHarness(Serial, contention) != 0)
+    {
+        Serial.println("heap allocated in a measured path");
+    }
+    Serial.println("done");
+}
+
+void loop()
+{
+}
@@ -0,0 +1,154 @@
+/**
+@file dawsLogDecode.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Binary log decoder
+
+ Host tool to format binary log dumps written by Log::dump().
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -o dawsLogDecode dawsLogDecode.cpp
+     ./dawsLogDecode capture.bin
+
+ The capture is the raw serial output.  It may contain other text between dumps; the tool finds each
+ dump by its header.  Each record is printed as
+
+     <time us> <formatted text>
+
+ The format strings are taken from src/dawsLogFormats.h so the tool must be rebuilt when formats are added.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "../../src/dawsLogFormats.h"
+
+/**
+ @brief Format strings indexed by format id
+ */
+static const char* const formats[LOG_FORMAT_COUNT] = {
+#define LOG_FMT(id, format) format,
+    DAWS_LOG_FORMATS
+#undef LOG_FMT
+};
+
+/**
+ @brief Read little endian value
+
+ @param p - pointer to first byte
+ @param size - number of bytes (up to 4)
+
+ @return value
+ */
+static uint32_t readLe(const uint8_t* p, int size)
+{
+    uint32_t value = 0;
+    for (int i = size - 1; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return(value);
+}
+
+/**
+ @brief Print one record
+
+ @param p - pointer to record as dumped
+ */
+static void printRecord(const uint8_t* p)
+{
+    uint32_t timeStamp = readLe(p + offsetof(logRecord_t, timeStamp), 4);
+    uint8_t format = p[offsetof(logRecord_t, format)];
+    int args[LOG_MAX_ARGS];
+    for (int i = 0; i < LOG_MAX_ARGS; i++)
+    {
+        args[i] = (int32_t)readLe(p + offsetof(logRecord_t, args) + i * 4, 4);
+    }
+    char text[256];
+    if (format >= LOG_FORMAT_COUNT)
+    {
+        snprintf(text, sizeof(text), "unknown format %d", format);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), formats[format], args[0], args[1], args[2], args[3]);
+    }
+    printf("%u %s\n", timeStamp, text);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: dawsLogDecode <capture.bin>" << std::endl;
+        return(2);
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return(2);
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const size_t magicLen = strlen(LOG_MAGIC);
+    size_t pos = 0;
+    int dumps = 0;
+    long records = 0;
+    uint32_t drops = 0;
+    while (pos + sizeof(logDumpHeader_t) <= data.size())
+    {
+        if (memcmp(&data[pos], LOG_MAGIC, magicLen) != 0)
+        {
+            pos++;
+            continue;
+        }
+        const uint8_t* hp = &data[pos];
+        uint8_t version = hp[offsetof(logDumpHeader_t, version)];
+        uint16_t count = readLe(hp + offsetof(logDumpHeader_t, count), 2);
+        uint16_t recordSize = readLe(hp + offsetof(logDumpHeader_t, recordSize), 2);
+        if (version != LOG_VERSION || recordSize != sizeof(logRecord_t))
+        {
+            std::cerr << "dump at " << pos << ": unsupported version or record size" << std::endl;
+            pos++;
+            continue;
+        }
+        drops = readLe(hp + offsetof(logDumpHeader_t, drops), 4);
+        pos += sizeof(logDumpHeader_t);
+        if (pos + (size_t)count * recordSize > data.size())
+        {
+            std::cerr << "dump truncated" << std::endl;
+            count = (data.size() - pos) / recordSize;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            printRecord(&data[pos]);
+            pos += recordSize;
+        }
+        dumps++;
+        records += count;
+    }
+    fprintf(stderr, "%d dumps, %ld records, %u dropped on target\n", dumps, records, drops);
+    return(dumps > 0 ? 0 : 1);
+}
@@ -0,0 +1,283 @@
+/**
+@file dawsPathGen.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Path table generator
+
+ Host tool to precompute the all pairs next hop table used by PathTable from a layout description.
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -o dawsPathGen dawsPathGen.cpp
+     ./dawsPathGen layout.txt myLayout > myLayout.h
+
+ The layout description is a text file with one statement per line.  Blank lines and anything
+ following # are ignored.
+
+     link <from> <to> <length> [<point>:<N|R> ...]
+     both <a> <b> <length> [<point>:<N|R> ...]
+
+ link defines a directed link from one block to another.  both defines links in both directions
+ with the same point requirements.  Blocks and points are numbered from 0.  The length is used to
+ choose the shortest path.  A layout with no links is rejected.
+
+ The output is a header defining a const pathTable_t with the given name.  Include it after dawsPathTable.h.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define MAX_BLOCKS 254  ///< block numbers must fit a byte with 0xFF reserved
+#define MAX_LINKS 254   ///< link indices must fit a byte with 0xFF (PATH_NONE) reserved
+
+/**
+ @brief Point requirement as parsed
+ */
+struct Req
+{
+    int point;  ///< point number
+    char pos;   ///< 'N' or 'R'
+};
+
+/**
+ @brief Link as parsed
+ */
+struct Link
+{
+    int from;               ///< start block
+    int to;                 ///< end block
+    long length;            ///< length used to find shortest path
+    std::vector<Req> reqs;  ///< point requirements
+};
+
+/**
+ @brief Report error and exit
+
+ @param line - line number in layout description, 0 if none
+ @param msg - message
+ */
+static void fail(int line, const std::string& msg)
+{
+    if (line > 0)
+    {
+        std::cerr << "line " << line << ": ";
+    }
+    std::cerr << msg << std::endl;
+    exit(1);
+}
+
+/**
+ @brief Parse layout description
+
+ @param in - input stream
+ @param links - where parsed links are added
+
+ @return number of blocks (highest block number + 1)
+ */
+static int parse(std::istream& in, std::vector<Link>& links)
+{
+    std::string text;
+    int lineNo = 0;
+    int blocks = 0;
+    while (std::getline(in, text))
+    {
+        lineNo++;
+        size_t hash = text.find('#');
+        if (hash != std::string::npos)
+        {
+            text.erase(hash);
+        }
+        std::istringstream line(text);
+        std::string keyword;
+        if (!(line >> keyword))
+        {
+            continue;   // blank
+        }
+        bool both = (keyword == "both");
+        if (!both && keyword != "link")
+        {
+            fail(lineNo, "unknown statement '" + keyword + "'");
+        }
+        Link link;
+        if (!(line >> link.from >> link.to >> link.length))
+        {
+            fail(lineNo, "expected <from> <to> <length>");
+        }
+        if (link.from < 0 || link.from >= MAX_BLOCKS || link.to < 0 || link.to >= MAX_BLOCKS)
+        {
+            fail(lineNo, "block number out of range");
+        }
+        if (link.length <= 0)
+        {
+            fail(lineNo, "length must be positive");
+        }
+        std::string reqText;
+        while (line >> reqText)
+        {
+            Req req;
+            char colon;
+            std::istringstream rs(reqText);
+            if (!(rs >> req.point >> colon >> req.pos) || colon != ':' || (req.pos != 'N' && req.pos != 'R')
+                || req.point < 0 || req.point > 255)
+            {
+                fail(lineNo, "bad point requirement '" + reqText + "'");
+            }
+            link.reqs.push_back(req);
+        }
+        links.push_back(link);
+        if (both)
+        {
+            std::swap(link.from, link.to);
+            links.push_back(link);
+        }
+        blocks = std::max(blocks, std::max(link.from, link.to) + 1);
+    }
+    if (links.empty())
+    {
+        fail(0, "no links - a layout needs at least one link");   // the tables would be empty arrays
+    }
+    if (links.size() > MAX_LINKS)
+    {
+        fail(0, "too many links");
+    }
+    size_t reqs = 0;
+    for (const Link& link : links)
+    {
+        if (link.reqs.size() > 255)
+        {
+            fail(0, "too many point requirements on one link");
+        }
+        reqs += link.reqs.size();
+    }
+    if (reqs > 65535)
+    {
+        fail(0, "too many point requirements");
+    }
+    return(blocks);
+}
+
+/**
+ @brief Main
+
+ Parse the layout, compute shortest paths (Floyd-Warshall) keeping the first link of
+ each path, and write the tables as a header.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: dawsPathGen <layout.txt> <name>" << std::endl;
+        return(2);
+    }
+    std::ifstream in(argv[1]);
+    if (!in)
+    {
+        fail(0, std::string("cannot open ") + argv[1]);
+    }
+    std::string name = argv[2];
+    std::vector<Link> links;
+    int n = parse(in, links);
+
+    const long INF = std::numeric_limits<long>::max() / 2;
+    std::vector<long> dist(n * n, INF);
+    std::vector<int> first(n * n, -1);  // first link on best path
+    for (size_t l = 0; l < links.size(); l++)
+    {
+        int ij = links[l].from * n + links[l].to;
+        if (links[l].from != links[l].to && links[l].length < dist[ij])
+        {
+            dist[ij] = links[l].length;
+            first[ij] = (int)l;
+        }
+    }
+    for (int k = 0; k < n; k++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            if (dist[i * n + k] >= INF)
+            {
+                continue;
+            }
+            for (int j = 0; j < n; j++)
+            {
+                long d = dist[i * n + k] + dist[k * n + j];
+                if (i != j && d < dist[i * n + j])
+                {
+                    dist[i * n + j] = d;
+                    first[i * n + j] = first[i * n + k];
+                }
+            }
+        }
+    }
+
+    std::ostream& out = std::cout;
+    out << "// Generated by dawsPathGen from " << argv[1] << " - do not edit\n\n";
+    out << "const pointReq_t " << name << "Reqs[] = {\n";
+    int reqCount = 0;
+    for (const Link& link : links)
+    {
+        for (const Req& req : link.reqs)
+        {
+            out << "    {" << req.point << ", " << (req.pos == 'N' ? "POINT_NORMAL" : "POINT_REVERSE") << "},\n";
+            reqCount++;
+        }
+    }
+    if (reqCount == 0)
+    {
+        out << "    {0, POINT_NORMAL}  // placeholder - no requirements\n";
+    }
+    out << "};\n\n";
+
+    out << "const pathLink_t " << name << "Links[] = {\n";
+    int reqFirst = 0;
+    for (const Link& link : links)
+    {
+        out << "    {" << link.to << ", " << link.reqs.size() << ", " << reqFirst << "},  // "
+            << link.from << " -> " << link.to << "\n";
+        reqFirst += (int)link.reqs.size();
+    }
+    out << "};\n\n";
+
+    out << "const byte " << name << "NextLink[] = {\n";
+    for (int i = 0; i < n; i++)
+    {
+        out << "    ";
+        for (int j = 0; j < n; j++)
+        {
+            out << (first[i * n + j] < 0 ? 0xFF : first[i * n + j]) << ",";
+        }
+        out << "  // from " << i << "\n";
+    }
+    out << "};\n\n";
+
+    out << "const pathTable_t " << name << " = {" << n << ", " << name << "NextLink, "
+        << name << "Links, " << name << "Reqs};\n";
+
+    std::cerr << n << " blocks, " << links.size() << " links, " << reqCount << " point requirements, "
+              << (n * n + links.size() * 4 + reqCount * 2) << " bytes of table" << std::endl;
+    return(0);
+}
@@ -0,0 +1,283 @@
+/**
+@file dawsRta.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Schedulability report
+
+ Host tool to check, by response time analysis, that each thread and ISR meets its deadline with
+ the configured priorities and the measured execution times.
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -o dawsRta dawsRta.cpp
+     ./dawsRta timing.txt
+
+ The timing file has one task per line.  Blank lines and anything following # are ignored.
+
+     thread <name> <priority> <period> <wcet> [<deadline> [<blocking>]]
+     isr <name> <nvic priority> <period> <wcet> [<deadline>]
+
+ Times are in microseconds.  The deadline defaults to the period.  Blocking is the longest time the thread
+ may wait for a lower priority thread holding a shared resource, e.g. MonitoredMutex maxBlocked.
+
+ Thread priorities are named as osPriority_t without the prefix (e.g. AboveNormal) or given as numbers.
+ ISR priorities are NVIC priorities - lower numbers are higher priority.  All ISRs pre-empt all threads.
+ For a sporadic task (e.g. a tag read) give the minimum time between events as the period.
+
+ The wcet is the execution time without pre-emption.  Pre-emption by higher priority tasks is added by the
+ analysis, so a time measured from release to completion (e.g. LoopMonitor maxExec) must not be given as the
+ wcet or the interference is counted twice.  Use the execution time harness for ISR costs and loop bodies
+ and ThreadStats CPU time for other threads.  LoopMonitor::printTiming() prints a line for a periodic thread
+ with the measured response after #, for comparison with the analysed response.
+
+ Threads of equal priority are assumed to interfere with each other, as the rtos may run any of
+ them first.
+
+ The exit status is 0 if every task meets its deadline, 1 if not.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+/**
+ @brief Task as parsed
+ */
+struct Task
+{
+    std::string name;   ///< task name
+    bool isr;           ///< true for ISR
+    int priority;       ///< thread: osPriority_t - higher is higher.  ISR: NVIC - lower is higher.
+    double period;      ///< period or minimum inter-arrival time (us)
+    double wcet;        ///< worst case execution time (us)
+    double deadline;    ///< deadline relative to release (us)
+    double blocking;    ///< worst case blocking by lower priority tasks (us)
+};
+
+/**
+ @brief Priority names as osPriority_t
+ */
+static const struct
+{
+    const char* name;
+    int priority;
+} priNames[] = {
+    {"Idle", 1},
+    {"Low", 8},
+    {"BelowNormal", 16},
+    {"Normal", 24},
+    {"AboveNormal", 32},
+    {"High", 40},
+    {"Realtime", 48}
+};
+
+/**
+ @brief Report error and exit
+
+ @param line - line number in timing file
+ @param msg - message
+ */
+static void fail(int line, const std::string& msg)
+{
+    std::cerr << "line " << line << ": " << msg << std::endl;
+    exit(2);
+}
+
+/**
+ @brief Parse priority
+
+ @param text - priority name or number
+ @param priority - where the priority is returned
+
+ @return true if valid
+ */
+static bool parsePriority(const std::string& text, int* priority)
+{
+    for (const auto& p : priNames)
+    {
+        if (strcasecmp(text.c_str(), p.name) == 0)
+        {
+            *priority = p.priority;
+            return(true);
+        }
+    }
+    char* end;
+    long value = strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || text.empty())
+    {
+        return(false);
+    }
+    *priority = (int)value;
+    return(true);
+}
+
+/**
+ @brief Does one task pre-empt or otherwise delay another
+
+ @param j - possibly interfering task
+ @param i - task under analysis
+
+ @return true if j can delay i
+ */
+static bool interferes(const Task& j, const Task& i)
+{
+    if (j.isr != i.isr)
+    {
+        return(j.isr);  // ISRs pre-empt threads, threads never pre-empt ISRs
+    }
+    if (i.isr)
+    {
+        return(j.priority <= i.priority);
+    }
+    return(j.priority >= i.priority);
+}
+
+/**
+ @brief Response time
+
+ Iterate R = C + B + sum over interfering tasks of ceil(R / Tj) * Cj to a fixed point.
+
+ @param tasks - all tasks
+ @param index - task under analysis
+
+ @return worst case response time (us), or a negative value if it exceeds the deadline
+ */
+static double responseTime(const std::vector<Task>& tasks, size_t index)
+{
+    const Task& ti = tasks[index];
+    double r = ti.wcet + ti.blocking;
+    while (true)
+    {
+        double next = ti.wcet + ti.blocking;
+        for (size_t j = 0; j < tasks.size(); j++)
+        {
+            if (j != index && interferes(tasks[j], ti))
+            {
+                next += std::ceil(r / tasks[j].period) * tasks[j].wcet;
+            }
+        }
+        if (next > ti.deadline)
+        {
+            return(-next);
+        }
+        if (next == r)
+        {
+            return(r);
+        }
+        r = next;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: dawsRta <timing.txt>" << std::endl;
+        return(2);
+    }
+    std::ifstream in(argv[1]);
+    if (!in)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return(2);
+    }
+    std::vector<Task> tasks;
+    std::string text;
+    int lineNo = 0;
+    while (std::getline(in, text))
+    {
+        lineNo++;
+        size_t hash = text.find('#');
+        if (hash != std::string::npos)
+        {
+            text.erase(hash);
+        }
+        std::istringstream line(text);
+        std::string kind;
+        std::string priority;
+        Task task;
+        if (!(line >> kind))
+        {
+            continue;
+        }
+        if (kind != "thread" && kind != "isr")
+        {
+            fail(lineNo, "expected thread or isr");
+        }
+        task.isr = (kind == "isr");
+        if (!(line >> task.name >> priority >> task.period >> task.wcet))
+        {
+            fail(lineNo, "expected <name> <priority> <period> <wcet>");
+        }
+        if (!parsePriority(priority, &task.priority))
+        {
+            fail(lineNo, "bad priority '" + priority + "'");
+        }
+        if (!(line >> task.deadline))
+        {
+            task.deadline = task.period;
+        }
+        if (!(line >> task.blocking))
+        {
+            task.blocking = 0;
+        }
+        if (task.period <= 0 || task.wcet < 0 || task.deadline <= 0)
+        {
+            fail(lineNo, "period and deadline must be positive");
+        }
+        tasks.push_back(task);
+    }
+
+    double utilisation = 0;
+    bool ok = true;
+    printf("%-16s %-6s %8s %10s %10s %10s %10s %10s  %s\n",
+           "task", "kind", "priority", "period", "wcet", "deadline", "response", "slack", "result");
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        const Task& t = tasks[i];
+        utilisation += t.wcet / t.period;
+        double r = responseTime(tasks, i);
+        bool meets = (r >= 0);
+        ok = ok && meets;
+        char response[16];
+        char slack[16];
+        if (meets)
+        {
+            snprintf(response, sizeof(response), "%.0f", r);
+            snprintf(slack, sizeof(slack), "%.0f", t.deadline - r);
+        }
+        else
+        {
+            snprintf(response, sizeof(response), ">%.0f", -r);
+            snprintf(slack, sizeof(slack), "-");
+        }
+        printf("%-16s %-6s %8d %10.0f %10.0f %10.0f %10s %10s  %s\n",
+               t.name.c_str(), t.isr ? "isr" : "thread", t.priority, t.period, t.wcet, t.deadline,
+               response, slack, meets ? "ok" : "MISSES DEADLINE");
+    }
+    printf("\nCPU utilisation %.1f%%\n", utilisation * 100);
+    printf("%s\n", ok ? "All tasks meet their deadlines" : "Not schedulable");
+    return(ok ? 0 : 1);
+}
@@ -0,0 +1,391 @@
+/**
+@file dawsTelemetryView.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Telemetry viewer
+
+ Host tool to decode the binary telemetry sent by Telemetry::send() (src/dawsTelemetryFormat.h).
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -o dawsTelemetryView dawsTelemetryView.cpp
+     ./dawsTelemetryView [-r] /dev/ttyACM0
+     ./dawsTelemetryView [-r] capture.bin
+
+ From a serial port the latest cycle is redrawn as each new cycle arrives.  The port is set to raw mode;
+ the USB serial port of the Nano 33 BLE ignores the baud rate.  From a capture file the last complete cycle is
+ shown.  With -r each frame is printed on its own line instead, e.g. to log or grep.
+
+ Frames are found by their sync bytes and checked by their CRC so text and corrupted frames are skipped and
+ counted.  The host must be little endian.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../../src/dawsTelemetryFormat.h"
+
+/**
+ @brief One cycle of telemetry
+ */
+struct Cycle
+{
+    bool started = false;
+    tlmCycle_t cycle = {};
+    std::map<int, tlmLatency_t> latency;    // by event type
+    std::map<int, tlmProfile_t> profiles;   // by event type
+    std::map<int, tlmLoop_t> loops;         // by reporter id
+    std::map<int, tlmThread_t> threads;     // by index
+};
+
+/**
+ @brief Copy payload
+
+ Payloads from a newer target may be longer and from an older one shorter.  Missing fields are 0.
+
+ @param p - payload
+ @param length - payload length
+
+ @return payload struct
+ */
+template <typename T>
+static T payload(const uint8_t* p, size_t length)
+{
+    T value;
+    memset(&value, 0, sizeof(value));
+    memcpy(&value, p, std::min(length, sizeof(value)));
+    return(value);
+}
+
+/**
+ @brief Name from payload
+
+ @param name - name field
+ @param size - field size
+
+ @return name - not nul terminated if it fills the field
+ */
+static std::string name(const char* name, size_t size)
+{
+    return(std::string(name, strnlen(name, size)));
+}
+
+/**
+ @brief Histogram as text
+
+ @param hist - power of two histogram
+
+ @return non-empty bins as <upper bound us>:<count>
+ */
+static std::string histogram(const uint32_t* hist)
+{
+    std::string text;
+    for (int b = 0; b < TLM_HIST_BINS; b++)
+    {
+        if (hist[b] != 0)
+        {
+            char bin[32];
+            if (b == TLM_HIST_BINS - 1)
+            {
+                snprintf(bin, sizeof(bin), " >:%u", hist[b]);
+            }
+            else
+            {
+                snprintf(bin, sizeof(bin), " <%u:%u", 1U << b, hist[b]);
+            }
+            text += bin;
+        }
+    }
+    return(text);
+}
+
+/**
+ @brief Telemetry frame reader and display
+ */
+class Viewer
+{
+public:
+    Viewer(bool raw, bool live) : _raw(raw), _live(live)
+    {
+    }
+
+    /**
+     @brief Add received bytes
+
+     Complete frames are decoded and removed.
+
+     @param p - bytes
+     @param length - number of bytes
+     */
+    void add(const uint8_t* p, size_t length)
+    {
+        _buffer.insert(_buffer.end(), p, p + length);
+        size_t pos = 0;
+        while (pos + TLM_HEADER_LEN <= _buffer.size())
+        {
+            if (_buffer[pos] != TLM_SYNC0 || _buffer[pos + 1] != TLM_SYNC1)
+            {
+                pos++;
+                _skipped++;
+                continue;
+            }
+            size_t length = _buffer[pos + 3];
+            size_t size = TLM_HEADER_LEN + length + 2;
+            if (pos + size > _buffer.size())
+            {
+                break;  // wait for the rest
+            }
+            const uint8_t* fp = &_buffer[pos];
+            uint16_t crc = fp[size - 2] | fp[size - 1] << 8;
+            if (tlmCrc(0xffff, fp + 2, TLM_HEADER_LEN - 2 + length) != crc)
+            {
+                _bad++;
+                pos++;
+                continue;
+            }
+            _frame(fp[2], fp + TLM_HEADER_LEN, length);
+            _frames++;
+            pos += size;
+        }
+        _buffer.erase(_buffer.begin(), _buffer.begin() + pos);
+    }
+
+    /**
+     @brief End of input
+
+     Show the last cycle, which may be incomplete, and the counts.
+     */
+    void finish()
+    {
+        if (!_raw)
+        {
+            _show(_current.started ? _current : _last);
+        }
+        fprintf(stderr, "%lu frames, %lu not valid, %lu bytes skipped\n", _frames, _bad, _skipped);
+    }
+
+private:
+    bool _raw;                      // print each frame
+    bool _live;                     // redraw each cycle
+    std::vector<uint8_t> _buffer;   // bytes not yet decoded
+    Cycle _current;                 // cycle being received
+    Cycle _last;                    // last complete cycle
+    unsigned long _frames = 0;
+    unsigned long _bad = 0;         // CRC wrong
+    unsigned long _skipped = 0;     // bytes outside frames
+
+    void _frame(int type, const uint8_t* p, size_t length)
+    {
+        switch (type)
+        {
+        case TLM_CYCLE:
+        {
+            tlmCycle_t cycle = payload<tlmCycle_t>(p, length);
+            if (_raw)
+            {
+                printf("cycle %u time %u queueFull %u queueLen %u samples %u/%u shed %u/%u/%u\n", cycle.cycle,
+                       cycle.time, cycle.queueFull, cycle.queueLen, cycle.otherSamples, cycle.totalSamples,
+                       cycle.shed[0], cycle.shed[1], cycle.shed[2]);
+                break;
+            }
+            if (_current.started)
+            {
+                _last = _current;
+                if (_live)
+                {
+                    _show(_last);
+                }
+            }
+            _current = Cycle();
+            _current.started = true;
+            _current.cycle = cycle;
+            break;
+        }
+        case TLM_LATENCY:
+        {
+            tlmLatency_t latency = payload<tlmLatency_t>(p, length);
+            if (_raw)
+            {
+                printf("latency event %u count %u report %u/%u wait %u/%u handler %u/%u\n", latency.eventType,
+                       latency.count, latency.meanReport, latency.maxReport, latency.meanWait, latency.maxWait,
+                       latency.meanHandler, latency.maxHandler);
+            }
+            _current.latency[latency.eventType] = latency;
+            break;
+        }
+        case TLM_PROFILE:
+        {
+            tlmProfile_t profile = payload<tlmProfile_t>(p, length);
+            if (_raw)
+            {
+                printf("profile event %u count %u mean %u max %u%s\n", profile.eventType, profile.count,
+                       profile.mean, profile.max, histogram(profile.hist).c_str());
+            }
+            _current.profiles[profile.eventType] = profile;
+            break;
+        }
+        case TLM_LOOP:
+        {
+            tlmLoop_t loop = payload<tlmLoop_t>(p, length);
+            if (_raw)
+            {
+                printf("loop %s period %u iterations %u misses %u exec %u/%u late %u%s\n",
+                       name(loop.name, sizeof(loop.name)).c_str(), loop.period, loop.iterations, loop.misses,
+                       loop.meanExec, loop.maxExec, loop.worstLateness, histogram(loop.jitter).c_str());
+            }
+            _current.loops[loop.id] = loop;
+            break;
+        }
+        case TLM_THREAD:
+        {
+            tlmThread_t thread = payload<tlmThread_t>(p, length);
+            if (_raw)
+            {
+                printf("thread %s cpu %u.%u%% switches %u stack %u/%u\n", name(thread.name, sizeof(thread.name)).c_str(),
+                       thread.cpuPermille / 10, thread.cpuPermille % 10, thread.switches, thread.stackMax,
+                       thread.stackSize);
+            }
+            _current.threads[thread.index] = thread;
+            break;
+        }
+        default:
+            if (_raw)
+            {
+                printf("type %d length %zu\n", type, length);
+            }
+            break;
+        }
+    }
+
+    void _show(const Cycle& c)
+    {
+        if (!c.started)
+        {
+            return;
+        }
+        if (_live)
+        {
+            printf("\033[H\033[J");
+        }
+        printf("cycle %u at %.3f s, reports dropped %u (capacity %u), frames %lu, not valid %lu\n",
+               c.cycle.cycle, c.cycle.time / 1e6, c.cycle.queueFull, c.cycle.queueLen, _frames, _bad);
+        printf("shed low %u normal %u critical %u\n\n", c.cycle.shed[0], c.cycle.shed[1], c.cycle.shed[2]);
+
+        printf("%-6s %10s | %-17s | %-17s | %-17s\n", "event", "count", "report mean/max", "wait mean/max",
+               "handler mean/max");
+        for (const auto& l : c.latency)
+        {
+            const tlmLatency_t& v = l.second;
+            printf("%-6u %10u | %8u %8u | %8u %8u | %8u %8u\n", v.eventType, v.count, v.meanReport, v.maxReport,
+                   v.meanWait, v.maxWait, v.meanHandler, v.maxHandler);
+        }
+        if (!c.profiles.empty())
+        {
+            printf("\nhandler profile (us)\n");
+            for (const auto& p : c.profiles)
+            {
+                const tlmProfile_t& v = p.second;
+                printf("event %-4u count %-8u mean %-6u max %-6u%s\n", v.eventType, v.count, v.mean, v.max,
+                       histogram(v.hist).c_str());
+            }
+        }
+        if (!c.loops.empty())
+        {
+            printf("\n%-12s %8s %10s %7s %17s %17s %8s\n", "loop", "period", "iterations", "misses",
+                   "period min/max", "exec mean/max", "late");
+            for (const auto& l : c.loops)
+            {
+                const tlmLoop_t& v = l.second;
+                printf("%-12s %8u %10u %7u %8u %8u %8u %8u %8u\n", name(v.name, sizeof(v.name)).c_str(), v.period,
+                       v.iterations, v.misses, v.minPeriod, v.maxPeriod, v.meanExec, v.maxExec, v.worstLateness);
+            }
+        }
+        if (!c.threads.empty())
+        {
+            printf("\n%-12s %8s %10s %10s %13s\n", "thread", "cpu %", "cpu us", "switches", "stack max");
+            for (const auto& t : c.threads)
+            {
+                const tlmThread_t& v = t.second;
+                printf("%-12s %6u.%u %10u %10u %6u/%-6u\n", name(v.name, sizeof(v.name)).c_str(),
+                       v.cpuPermille / 10, v.cpuPermille % 10, v.cpuTime, v.switches, v.stackMax, v.stackSize);
+            }
+            if (c.cycle.totalSamples != 0)
+            {
+                printf("%-12s %6.1f\n", "other", c.cycle.otherSamples * 100.0 / c.cycle.totalSamples);
+            }
+        }
+        fflush(stdout);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    bool raw = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "r")) != -1)
+    {
+        if (opt == 'r')
+        {
+            raw = true;
+        }
+        else
+        {
+            optind = argc;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        std::cerr << "usage: dawsTelemetryView [-r] <port|capture.bin>" << std::endl;
+        return(2);
+    }
+    int fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        std::cerr << "cannot open " << argv[optind] << std::endl;
+        return(2);
+    }
+    bool live = isatty(fd);
+    if (live)
+    {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0)
+        {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    Viewer viewer(raw, live && isatty(STDOUT_FILENO));
+    uint8_t buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        viewer.add(buffer, n);
+    }
+    viewer.finish();
+    close(fd);
+    return(0);
+}
@@ -0,0 +1,786 @@
+/**
+@file dawsTraceAnalyze.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.b
+
+@brief Trace analyzer
+
+ Host tool to summarise large trace captures written by Trace::dump() or Trace::stream().
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -pthread -o dawsTraceAnalyze dawsTraceAnalyze.cpp
+     ./dawsTraceAnalyze [-j threads] [-g gap] [-n count] capture.bin
+
+ The capture is memory mapped and split into parts, runs of trace chunks, which are decoded and analysed
+ in parallel, by default on all cores.  The results are merged in capture order.  The tool reports
+ - the rate, drop count and latency percentiles of each event type.  Latency is split into event to
+   queue, queue wait and handler times, as Reporter::markHandled().
+ - the rate, drops and bursts of each reporter.  A burst is at least count (-n, default 5) reports
+   from one reporter each within gap (-g, default 1000) us of the previous one.
+ - the report queue depth when each report was queued.  This is reconstructed from the enqueue and dequeue
+   times, as the queue is first in first out and there is a single reader.
+ - which reporters and event types occupied the queue when reports were dropped.
+
+ Percentiles are from log linear histograms, within 3%.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "dawsTraceFile.h"
+
+#define HIST_LINEAR 64          ///< histogram buckets of 1us
+#define HIST_SUB_BITS 5         ///< log2 of buckets per power of two above that
+#define HIST_BUCKETS (HIST_LINEAR + (32 - 6) * (1 << HIST_SUB_BITS))
+#define DEPTH_LOOKBACK 64       ///< reports searched back for queue depth - more than the queue length
+#define DROP_LOOKAHEAD 256      ///< records searched forward for the queue occupants at a drop
+#define MAX_DEPTH 64            ///< queue depth histogram size
+#define PART_RECORDS 65536      ///< records per part
+
+/**
+ @brief Latency histogram
+
+ Log linear: 1us buckets up to 64us, then 32 buckets per power of two.
+ */
+class Histogram
+{
+public:
+    void add(uint32_t value)
+    {
+        _buckets[_bucket(value)]++;
+        _count++;
+        _max = std::max(_max, value);
+    }
+
+    void merge(const Histogram& other)
+    {
+        for (int i = 0; i < HIST_BUCKETS; i++)
+        {
+            _buckets[i] += other._buckets[i];
+        }
+        _count += other._count;
+        _max = std::max(_max, other._max);
+    }
+
+    uint64_t getCount() const
+    {
+        return(_count);
+    }
+
+    uint32_t getMax() const
+    {
+        return(_max);
+    }
+
+    /**
+     @brief Percentile
+
+     @param p - fraction, e.g. 0.99
+
+     @return value at the percentile - middle of its bucket
+     */
+    uint32_t percentile(double p) const
+    {
+        if (_count == 0)
+        {
+            return(0);
+        }
+        uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p * _count + 0.999999));
+        uint64_t seen = 0;
+        for (int i = 0; i < HIST_BUCKETS; i++)
+        {
+            seen += _buckets[i];
+            if (seen >= rank)
+            {
+                return(std::min(_max, _value(i)));
+            }
+        }
+        return(_max);
+    }
+
+private:
+    uint64_t _buckets[HIST_BUCKETS] = {};
+    uint64_t _count = 0;
+    uint32_t _max = 0;
+
+    static int _bucket(uint32_t value)
+    {
+        if (value < HIST_LINEAR)
+        {
+            return(value);
+        }
+        int e = 31 - __builtin_clz(value);     // 6 or more
+        int sub = (value >> (e - HIST_SUB_BITS)) & ((1 << HIST_SUB_BITS) - 1);
+        return(HIST_LINEAR + (e - 6) * (1 << HIST_SUB_BITS) + sub);
+    }
+
+    static uint32_t _value(int bucket)
+    {
+        if (bucket < HIST_LINEAR)
+        {
+            return(bucket);
+        }
+        int e = (bucket - HIST_LINEAR) / (1 << HIST_SUB_BITS) + 6;
+        int sub = (bucket - HIST_LINEAR) % (1 << HIST_SUB_BITS);
+        uint64_t low = ((uint64_t)(1 << HIST_SUB_BITS) + sub) << (e - HIST_SUB_BITS);
+        uint64_t width = (uint64_t)1 << (e - HIST_SUB_BITS);
+        return((uint32_t)std::min<uint64_t>(low + width / 2, UINT32_MAX));
+    }
+};
+
+/**
+ @brief Latency kinds as Reporter::markHandled()
+ */
+enum Latency
+{
+    LAT_REPORT,     ///< event to queue
+    LAT_WAIT,       ///< queue wait
+    LAT_HANDLER,    ///< handler
+    LAT_TOTAL,      ///< event to handled
+    LAT_KINDS
+};
+
+/**
+ @brief Statistics for an event type
+ */
+struct EventStats
+{
+    uint64_t count = 0;         ///< reports handled
+    uint64_t drops = 0;         ///< reports dropped
+    uint64_t occupying = 0;     ///< reports in the queue when any report was dropped
+    Histogram latency[LAT_KINDS];
+
+    void merge(const EventStats& other)
+    {
+        count += other.count;
+        drops += other.drops;
+        occupying += other.occupying;
+        for (int i = 0; i < LAT_KINDS; i++)
+        {
+            latency[i].merge(other.latency[i]);
+        }
+    }
+};
+
+/**
+ @brief Burst runs of one reporter in a part
+
+ The first and last runs may continue into the previous and next parts so are held open until merged.
+ Runs wholly inside are complete.
+ */
+struct Runs
+{
+    bool any = false;       ///< reporter has reports in the part
+    bool whole = false;     ///< one run covers all - head and tail are the same
+    uint32_t first = 0;     ///< first arrival
+    uint32_t last = 0;      ///< last arrival
+    uint64_t head = 0;      ///< length of first run
+    uint64_t tail = 0;      ///< length of last run
+    uint64_t bursts = 0;    ///< complete runs that are bursts
+    uint64_t inBursts = 0;  ///< reports in those bursts
+    uint64_t longest = 0;   ///< longest complete burst
+};
+
+/**
+ @brief Statistics for a reporter
+ */
+struct ReporterStats
+{
+    uint64_t count = 0;         ///< reports handled
+    uint64_t drops = 0;         ///< reports dropped
+    uint64_t occupying = 0;     ///< reports in the queue when any report was dropped
+    Histogram total;            ///< event to handled latency
+    Runs runs;                  ///< bursts
+};
+
+/**
+ @brief Analysis options
+ */
+struct Options
+{
+    int threads = 0;            ///< worker threads - 0 for all cores
+    uint32_t burstGap = 1000;   ///< maximum us between reports in a burst
+    uint64_t burstMin = 5;      ///< minimum reports in a burst
+};
+
+static Options options;
+
+/**
+ @brief Close a run
+
+ @param runs - runs
+ @param length - run length
+ */
+static void closeRun(Runs* runs, uint64_t length)
+{
+    if (length >= options.burstMin)
+    {
+        runs->bursts++;
+        runs->inBursts += length;
+        runs->longest = std::max(runs->longest, length);
+    }
+}
+
+/**
+ @brief Add arrival to runs
+
+ @param runs - runs
+ @param t - arrival time
+ */
+static void arrive(Runs* runs, uint32_t t)
+{
+    if (!runs->any)
+    {
+        runs->any = true;
+        runs->whole = true;
+        runs->first = t;
+        runs->last = t;
+        runs->head = 1;
+        runs->tail = 1;
+        return;
+    }
+    int32_t gap = traceDiff(t, runs->last);
+    if (gap <= (int32_t)options.burstGap)
+    {
+        // reports are in handled order so arrivals may be slightly out of order
+        runs->tail++;
+        if (runs->whole)
+        {
+            runs->head++;
+        }
+        if (gap > 0)
+        {
+            runs->last = t;
+        }
+        return;
+    }
+    if (!runs->whole)
+    {
+        closeRun(runs, runs->tail);
+    }
+    runs->whole = false;
+    runs->tail = 1;
+    runs->last = t;
+}
+
+/**
+ @brief Merge runs of adjacent parts
+
+ @param a - runs of the earlier part - updated
+ @param b - runs of the later part
+ */
+static void mergeRuns(Runs* a, const Runs& b)
+{
+    if (!b.any)
+    {
+        return;
+    }
+    if (!a->any)
+    {
+        *a = b;
+        return;
+    }
+    Runs r;
+    r.any = true;
+    r.first = a->first;
+    r.last = b.last;
+    r.bursts = a->bursts + b.bursts;
+    r.inBursts = a->inBursts + b.inBursts;
+    r.longest = std::max(a->longest, b.longest);
+    if (traceDiff(b.first, a->last) <= (int32_t)options.burstGap)
+    {
+        uint64_t joined = a->tail + b.head;
+        r.whole = a->whole && b.whole;
+        r.head = a->whole ? joined : a->head;
+        r.tail = b.whole ? joined : b.tail;
+        if (!a->whole && !b.whole)
+        {
+            closeRun(&r, joined);
+        }
+    }
+    else
+    {
+        r.head = a->head;
+        r.tail = b.tail;
+        if (!a->whole)
+        {
+            closeRun(&r, a->tail);
+        }
+        if (!b.whole)
+        {
+            closeRun(&r, b.head);
+        }
+    }
+    *a = r;
+}
+
+/**
+ @brief Reporter key
+
+ @param record - trace record
+
+ @return reporter type and id as one number
+ */
+static int reporterKey(const traceRecord_t& record)
+{
+    return(record.reporterType * 256 + record.id);
+}
+
+/**
+ @brief Part of the capture and its results
+
+ A run of trace chunks analysed by one thread.
+ */
+struct Part
+{
+    size_t begin;                       ///< first trace chunk
+    size_t end;                         ///< after last trace chunk
+
+    uint64_t reports = 0;
+    uint64_t drops = 0;
+    uint64_t spans = 0;
+    uint32_t firstTime = 0;             ///< first record time
+    uint32_t lastTime = 0;              ///< last record time
+    int64_t span = 0;                   ///< last less first, unwrapped
+    uint64_t depth[MAX_DEPTH + 1] = {}; ///< queue depth histogram - at each enqueue
+    uint64_t occupants = 0;             ///< reports in the queue when a report was dropped
+    uint64_t invalid = 0;               ///< trace chunks that could not be decoded
+    std::map<int, std::unique_ptr<EventStats>> events;
+    std::map<int, ReporterStats> reporters;
+};
+
+/**
+ @brief Event statistics for a type
+
+ @param part - part
+ @param type - event type
+
+ @return statistics - created if new
+ */
+static EventStats* eventStats(Part* part, int type)
+{
+    std::unique_ptr<EventStats>& sp = part->events[type];
+    if (!sp)
+    {
+        sp.reset(new EventStats);
+    }
+    return(sp.get());
+}
+
+/**
+ @brief Find the queue occupants at a drop
+
+ The reports in the queue at the drop are handled after it so are recorded after it.  They are
+ those with enqueue time before and dequeue time after the drop.
+
+ @param part - part - occupant counts updated
+ @param records - decoded records
+ @param at - index of drop record
+ @param t - time of drop
+ */
+static void dropOccupants(Part* part, const std::vector<traceRecord_t>& records, size_t at, uint32_t t)
+{
+    size_t end = std::min(records.size(), at + DROP_LOOKAHEAD);
+    for (size_t i = at + 1; i < end; i++)
+    {
+        const traceRecord_t& record = records[i];
+        if (record.kind != TRACE_REPORT)
+        {
+            continue;
+        }
+        if (traceDiff(record.time[1], t) > 0)
+        {
+            break;  // queued after the drop - so are all later reports
+        }
+        if (traceDiff(record.time[2], t) > 0)
+        {
+            part->occupants++;
+            eventStats(part, record.eventType)->occupying++;
+            part->reporters[reporterKey(record)].occupying++;
+        }
+    }
+}
+
+/**
+ @brief Analyse part
+
+ The trace chunks just before and after the part, if there are none missing, are also decoded
+ for the queue depth and the occupants at drops.
+
+ @param capture - capture
+ @param part - part - results filled in
+ */
+static void analyse(const TraceFile& capture, Part* part)
+{
+    const std::vector<TraceChunk>& chunks = capture.getChunks();
+    std::vector<traceRecord_t> records;
+
+    // chunks before for enough reports to find the queue depth
+    size_t first = part->begin;
+    uint64_t before = 0;
+    while (first > 0 && before < DEPTH_LOOKBACK && TraceFile::follows(chunks[first - 1], chunks[first]))
+    {
+        first--;
+        before += chunks[first].count;
+    }
+    for (size_t c = first; c < part->begin; c++)
+    {
+        TraceFile::decode(chunks[c], &records);
+    }
+    size_t begin = records.size();
+    for (size_t c = part->begin; c < part->end; c++)
+    {
+        if (!TraceFile::decode(chunks[c], &records))
+        {
+            part->invalid++;
+        }
+    }
+    size_t end = records.size();
+    // chunks after for the occupants at drops
+    for (size_t c = part->end; c < chunks.size() && records.size() < end + DROP_LOOKAHEAD &&
+         TraceFile::follows(chunks[c - 1], chunks[c]); c++)
+    {
+        TraceFile::decode(chunks[c], &records);
+    }
+
+    uint32_t outTimes[DEPTH_LOOKBACK];  // dequeue times of the latest reports - ring
+    uint32_t outCount = 0;
+    for (size_t i = 0; i < begin; i++)
+    {
+        if (records[i].kind == TRACE_REPORT)
+        {
+            outTimes[outCount++ % DEPTH_LOOKBACK] = records[i].time[2];
+        }
+    }
+
+    TraceUnwrapper unwrapper;
+    int64_t firstTime = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        const traceRecord_t& record = records[i];
+        uint32_t t = traceRecordTime(&record);
+        int64_t unwrapped = unwrapper.unwrap(t);
+        if (i == begin)
+        {
+            part->firstTime = t;
+            firstTime = unwrapped;
+        }
+        part->lastTime = t;
+        part->span = unwrapped - firstTime;
+
+        switch (record.kind)
+        {
+        case TRACE_REPORT:
+        {
+            part->reports++;
+            EventStats* ep = eventStats(part, record.eventType);
+            ReporterStats& rs = part->reporters[reporterKey(record)];
+            uint32_t report = std::max(0, traceDiff(record.time[1], record.time[0]));
+            uint32_t wait = std::max(0, traceDiff(record.time[2], record.time[1]));
+            uint32_t handler = std::max(0, traceDiff(record.time[3], record.time[2]));
+            uint32_t total = std::max(0, traceDiff(record.time[3], record.time[0]));
+            ep->count++;
+            ep->latency[LAT_REPORT].add(report);
+            ep->latency[LAT_WAIT].add(wait);
+            ep->latency[LAT_HANDLER].add(handler);
+            ep->latency[LAT_TOTAL].add(total);
+            rs.count++;
+            rs.total.add(total);
+            arrive(&rs.runs, record.time[1]);
+
+            // depth - this report and the earlier ones not yet dequeued when it was queued
+            uint32_t depth = 1;
+            uint32_t back = std::min<uint32_t>(outCount, DEPTH_LOOKBACK);
+            for (uint32_t b = 1; b <= back; b++)
+            {
+                if (traceDiff(outTimes[(outCount - b) % DEPTH_LOOKBACK], record.time[1]) <= 0)
+                {
+                    break;  // dequeue times are in order
+                }
+                depth++;
+            }
+            part->depth[std::min<uint32_t>(depth, MAX_DEPTH)]++;
+            outTimes[outCount++ % DEPTH_LOOKBACK] = record.time[2];
+            break;
+        }
+        case TRACE_DROP:
+        {
+            part->drops++;
+            eventStats(part, record.eventType)->drops++;
+            ReporterStats& rs = part->reporters[reporterKey(record)];
+            rs.drops++;
+            arrive(&rs.runs, record.time[0]);
+            dropOccupants(part, records, i, record.time[0]);
+            break;
+        }
+        case TRACE_SPAN:
+            part->spans++;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ @brief Reporter name
+
+ @param key - reporter key
+
+ @return reporter type character and id, e.g. V3
+ */
+static std::string reporterName(int key)
+{
+    return(std::string(1, (char)(key / 256)) + std::to_string(key % 256));
+}
+
+/**
+ @brief Print percentiles
+
+ @param h - histogram
+ */
+static void printPercentiles(const Histogram& h)
+{
+    printf(" %7u %7u %7u %8u", h.percentile(0.5), h.percentile(0.99), h.percentile(0.999), h.getMax());
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "j:g:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            options.threads = atoi(optarg);
+            break;
+        case 'g':
+            options.burstGap = strtoul(optarg, nullptr, 10);
+            break;
+        case 'n':
+            options.burstMin = std::max(2UL, strtoul(optarg, nullptr, 10));
+            break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        std::cerr << "usage: dawsTraceAnalyze [-j threads] [-g gap us] [-n burst count] <capture.bin>" << std::endl;
+        return(2);
+    }
+    auto started = std::chrono::steady_clock::now();
+    TraceFile capture;
+    if (!capture.open(argv[optind]))
+    {
+        std::cerr << "cannot open " << argv[optind] << std::endl;
+        return(2);
+    }
+    if (capture.getChunks().empty())
+    {
+        std::cerr << "no trace chunks found" << std::endl;
+        return(1);
+    }
+
+    // split into parts - independent of the thread count so the results are too
+    const std::vector<TraceChunk>& chunks = capture.getChunks();
+    int threads = options.threads > 0 ? options.threads : std::max(1U, std::thread::hardware_concurrency());
+    std::vector<Part> parts;
+    size_t begin = 0;
+    uint64_t count = 0;
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        count += chunks[c].count;
+        if (count >= PART_RECORDS || c + 1 == chunks.size())
+        {
+            Part part;
+            part.begin = begin;
+            part.end = c + 1;
+            parts.push_back(std::move(part));
+            begin = c + 1;
+            count = 0;
+        }
+    }
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threads; w++)
+    {
+        workers.emplace_back([&]()
+        {
+            size_t i;
+            while ((i = next++) < parts.size())
+            {
+                analyse(capture, &parts[i]);
+            }
+        });
+    }
+    for (std::thread& w : workers)
+    {
+        w.join();
+    }
+
+    // merge in capture order
+    uint64_t reports = 0;
+    uint64_t drops = 0;
+    uint64_t spans = 0;
+    uint64_t occupants = 0;
+    int64_t duration = 0;
+    uint64_t depth[MAX_DEPTH + 1] = {};
+    std::map<int, EventStats> events;
+    std::map<int, ReporterStats> reporters;
+    uint64_t invalid = 0;
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        Part& part = parts[i];
+        reports += part.reports;
+        drops += part.drops;
+        spans += part.spans;
+        occupants += part.occupants;
+        invalid += part.invalid;
+        duration += part.span;
+        if (i > 0)
+        {
+            duration += std::max(0, traceDiff(part.firstTime, parts[i - 1].lastTime));
+        }
+        for (int d = 0; d <= MAX_DEPTH; d++)
+        {
+            depth[d] += part.depth[d];
+        }
+        for (auto& e : part.events)
+        {
+            events[e.first].merge(*e.second);
+        }
+        for (auto& r : part.reporters)
+        {
+            ReporterStats& rs = reporters[r.first];
+            rs.count += r.second.count;
+            rs.drops += r.second.drops;
+            rs.occupying += r.second.occupying;
+            rs.total.merge(r.second.total);
+            mergeRuns(&rs.runs, r.second.runs);
+        }
+        part.events.clear();
+    }
+    for (auto& r : reporters)
+    {
+        Runs& runs = r.second.runs;
+        closeRun(&runs, runs.head);
+        if (!runs.whole)
+        {
+            closeRun(&runs, runs.tail);
+        }
+    }
+    double seconds = std::max<int64_t>(duration, 1) / 1e6;
+
+    printf("%zu chunks, %llu records: %llu reports, %llu drops, %llu spans\n", chunks.size(),
+           (unsigned long long)capture.getRecordCount(), (unsigned long long)reports, (unsigned long long)drops,
+           (unsigned long long)spans);
+    printf("%llu records lost on target, %llu chunks missing, %llu chunks not valid\n",
+           (unsigned long long)capture.getLost(), (unsigned long long)capture.getMissing(),
+           (unsigned long long)invalid);
+    printf("encoded %.2f bytes per record\n",
+           capture.getRecordCount() ? (double)capture.getEncodedBytes() / capture.getRecordCount() : 0.0);
+    printf("duration %.3f s\n", seconds);
+
+    printf("\nEvent types (latency us: p50 p99 p99.9 max)\n");
+    printf("%-6s %10s %9s %8s | %-33s | %-33s | %-33s | %-33s\n", "event", "count", "rate/s", "drops",
+           "report", "wait", "handler", "total");
+    for (auto& e : events)
+    {
+        const EventStats& es = e.second;
+        printf("%-6d %10llu %9.2f %8llu |", e.first, (unsigned long long)es.count, es.count / seconds,
+               (unsigned long long)es.drops);
+        for (int k = 0; k < LAT_KINDS; k++)
+        {
+            printPercentiles(es.latency[k]);
+            printf(" |");
+        }
+        printf("\n");
+    }
+
+    printf("\nReporters (bursts of %llu or more within %u us)\n", (unsigned long long)options.burstMin,
+           options.burstGap);
+    printf("%-8s %10s %9s %8s %8s %8s %8s %9s %9s\n", "reporter", "count", "rate/s", "drops", "bursts",
+           "longest", "inBurst%", "total p99", "total max");
+    for (auto& r : reporters)
+    {
+        const ReporterStats& rs = r.second;
+        uint64_t arrivals = rs.count + rs.drops;
+        printf("%-8s %10llu %9.2f %8llu %8llu %8llu %8.1f %9u %9u\n", reporterName(r.first).c_str(),
+               (unsigned long long)rs.count, rs.count / seconds, (unsigned long long)rs.drops,
+               (unsigned long long)rs.runs.bursts, (unsigned long long)rs.runs.longest,
+               arrivals ? 100.0 * rs.runs.inBursts / arrivals : 0.0, rs.total.percentile(0.99), rs.total.getMax());
+    }
+
+    uint64_t depthCount = 0;
+    uint64_t depthSum = 0;
+    int maxDepth = 0;
+    for (int d = 0; d <= MAX_DEPTH; d++)
+    {
+        depthCount += depth[d];
+        depthSum += depth[d] * d;
+        if (depth[d] > 0)
+        {
+            maxDepth = d;
+        }
+    }
+    printf("\nQueue depth when queued: mean %.2f, max %d%s\n", depthCount ? (double)depthSum / depthCount : 0.0,
+           maxDepth, maxDepth == MAX_DEPTH ? " or more" : "");
+    for (int d = 1; d <= maxDepth; d++)
+    {
+        printf("  %3d %10llu %6.2f%%\n", d, (unsigned long long)depth[d], 100.0 * depth[d] / depthCount);
+    }
+
+    if (drops > 0)
+    {
+        printf("\nQueue occupants when reports were dropped: mean %.2f per drop\n", (double)occupants / drops);
+        printf("%-8s %10s %7s\n", "reporter", "occupying", "share");
+        for (auto& r : reporters)
+        {
+            if (r.second.occupying > 0)
+            {
+                printf("%-8s %10llu %6.1f%%\n", reporterName(r.first).c_str(),
+                       (unsigned long long)r.second.occupying, 100.0 * r.second.occupying / occupants);
+            }
+        }
+        printf("%-8s %10s %7s\n", "event", "occupying", "share");
+        for (auto& e : events)
+        {
+            if (e.second.occupying > 0)
+            {
+                printf("%-8d %10llu %6.1f%%\n", e.first, (unsigned long long)e.second.occupying,
+                       100.0 * e.second.occupying / occupants);
+            }
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    fprintf(stderr, "analysed in %.2f s using %d threads, %zu parts\n", elapsed, threads, parts.size());
+    return(0);
+}
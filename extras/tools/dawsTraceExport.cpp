@@ -0,0 +1,341 @@
+/**
+@file dawsTraceExport.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.b
+
+@brief Trace export
+
+ Host tool to convert traces written by Trace::dump() or Trace::stream() to Chrome trace event format (JSON), which
+ may be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+
+ Build and run on the host:
+
+     g++ -std=c++17 -O2 -o dawsTraceExport dawsTraceExport.cpp
+     ./dawsTraceExport capture.bin > trace.json
+
+ The capture is the raw serial output of Trace::dump() or Trace::stream().  It may contain other text; the
+ tool finds the trace chunks by their headers.
+
+ The timeline has
+ - a track for each reporter (e.g. V3 - VL53 reporter id 3) with the time from event to queue and
+   the time queued for each report, and any reports dropped as the queue was full
+ - a report handler track with the time handling each report
+ - a flow from each report being queued to it being handled
+ - a track for each named thread (e.g. a LoopMonitor) with its activity spans
+
+ Events are named from src/dawsEventTypes.h so the tool must be rebuilt when event types are added.
+
+ Times on the target are micros() which wraps every 71 minutes.  They are unwrapped assuming
+ successive records are less than 35 minutes apart.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "dawsTraceFile.h"
+#include "../../src/dawsEventTypes.h"
+
+/**
+ @brief Event type names indexed by event type
+ */
+static const char* const eventNames[] = {
+#define EVENT_TYPE(id) #id,
+    DAWS_EVENT_TYPES
+#undef EVENT_TYPE
+};
+
+#define PID_REPORTERS 1     ///< process grouping reporter and handler tracks
+#define PID_THREADS 2       ///< process grouping thread tracks
+#define TID_HANDLER 0       ///< report handler track
+
+/**
+ @brief Quote string for JSON
+
+ @param text - string
+
+ @return quoted and escaped string
+ */
+static std::string quote(const std::string& text)
+{
+    std::string out = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < ' ')
+        {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return(out + "\"");
+}
+
+/**
+ @brief JSON trace event writer
+ */
+class Writer
+{
+public:
+    explicit Writer(FILE* out) : _out(out)
+    {
+        fprintf(_out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    }
+
+    ~Writer()
+    {
+        fprintf(_out, "\n]}\n");
+    }
+
+    /**
+     @brief Name a process or thread
+     */
+    void meta(const char* what, int pid, int tid, const std::string& name)
+    {
+        _begin();
+        fprintf(_out, "{\"ph\":\"M\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":%s}}",
+                what, pid, tid, quote(name).c_str());
+    }
+
+    /**
+     @brief Complete event - a span
+     */
+    void span(const std::string& name, int pid, int tid, int64_t ts, int64_t dur, const std::string& args)
+    {
+        _begin();
+        fprintf(_out, "{\"ph\":\"X\",\"name\":%s,\"pid\":%d,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"args\":{%s}}",
+                quote(name).c_str(), pid, tid, (long long)ts, (long long)(dur < 0 ? 0 : dur), args.c_str());
+    }
+
+    /**
+     @brief Instant event
+     */
+    void instant(const std::string& name, int pid, int tid, int64_t ts)
+    {
+        _begin();
+        fprintf(_out, "{\"ph\":\"i\",\"s\":\"t\",\"name\":%s,\"pid\":%d,\"tid\":%d,\"ts\":%lld}",
+                quote(name).c_str(), pid, tid, (long long)ts);
+    }
+
+    /**
+     @brief Flow event - start (ph s) or finish (ph f)
+     */
+    void flow(char ph, long id, int pid, int tid, int64_t ts)
+    {
+        _begin();
+        fprintf(_out, "{\"ph\":\"%c\",\"name\":\"report\",\"cat\":\"report\",\"id\":%ld,\"pid\":%d,\"tid\":%d,\"ts\":%lld%s}",
+                ph, id, pid, tid, (long long)ts, ph == 'f' ? ",\"bp\":\"e\"" : "");
+    }
+
+private:
+    FILE* _out;
+    bool _first = true;
+
+    void _begin()
+    {
+        if (!_first)
+        {
+            fprintf(_out, ",\n");
+        }
+        _first = false;
+    }
+};
+
+/**
+ @brief Reporter track id
+
+ @param record - trace record
+
+ @return thread id for the reporter's track
+ */
+static int reporterTid(const traceRecord_t& record)
+{
+    return(record.reporterType * 256 + record.id + 1);
+}
+
+/**
+ @brief Reporter track name
+
+ @param record - trace record
+
+ @return reporter type character and id, e.g. V3
+ */
+static std::string reporterName(const traceRecord_t& record)
+{
+    return(std::string(1, (char)record.reporterType) + std::to_string(record.id));
+}
+
+/**
+ @brief Event name
+
+ @param record - trace record
+
+ @return event type name, e.g. VL53_RANGE_CLOSE, or its number if the type is newer than this tool
+ */
+static std::string eventName(const traceRecord_t& record)
+{
+    if (record.eventType < sizeof(eventNames) / sizeof(eventNames[0]))
+    {
+        return(eventNames[record.eventType]);
+    }
+    return("event " + std::to_string(record.eventType));
+}
+
+/**
+ @brief Trace exporter
+
+ Converts records, in capture order, to trace events.
+ */
+class Exporter
+{
+public:
+    Exporter(Writer& out, const std::map<int, std::string>& names) : _out(out), _names(names)
+    {
+        _out.meta("process_name", PID_REPORTERS, 0, "reporters");
+        _out.meta("process_name", PID_THREADS, 0, "threads");
+        _out.meta("thread_name", PID_REPORTERS, TID_HANDLER, "report handler");
+    }
+
+    /**
+     @brief Export one record
+     */
+    void add(const traceRecord_t& record)
+    {
+        int64_t t[4];
+        int last = (record.kind == TRACE_REPORT) ? 3 : (record.kind == TRACE_SPAN) ? 1 : 0;
+        for (int i = 0; i <= last; i++)
+        {
+            t[i] = _unwrapper.unwrap(record.time[i]);
+        }
+        if (_origin < 0)
+        {
+            _origin = t[0];
+        }
+        for (int i = 0; i <= last; i++)
+        {
+            t[i] -= _origin;
+        }
+
+        switch (record.kind)
+        {
+        case TRACE_REPORT:
+        {
+            int tid = _reporterTrack(record);
+            std::string args = "\"info\":" + std::to_string(record.info) +
+                               ",\"reporter\":" + quote(reporterName(record));
+            if (t[1] > t[0])
+            {
+                _out.span(eventName(record) + " report", PID_REPORTERS, tid, t[0], t[1] - t[0], args);
+            }
+            _out.span(eventName(record) + " queued", PID_REPORTERS, tid, t[1], t[2] - t[1], args);
+            _out.span(eventName(record), PID_REPORTERS, TID_HANDLER, t[2], t[3] - t[2], args);
+            _out.flow('s', _flowId, PID_REPORTERS, tid, t[1]);
+            _out.flow('f', _flowId, PID_REPORTERS, TID_HANDLER, t[2]);
+            _flowId++;
+            break;
+        }
+        case TRACE_DROP:
+            _out.instant("drop " + eventName(record), PID_REPORTERS, _reporterTrack(record), t[0]);
+            break;
+        case TRACE_SPAN:
+        {
+            auto name = _names.find(record.id);
+            std::string trackName = (name != _names.end()) ? name->second : "track " + std::to_string(record.id);
+            if (_threads.insert(record.id).second)
+            {
+                _out.meta("thread_name", PID_THREADS, record.id, trackName);
+            }
+            _out.span(trackName, PID_THREADS, record.id, t[0], t[1] - t[0], "");
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+private:
+    Writer& _out;
+    const std::map<int, std::string>& _names;   // thread track names
+    TraceUnwrapper _unwrapper;
+    int64_t _origin = -1;                       // first time - shown as 0
+    std::set<int> _reporters;                   // reporter tracks named so far
+    std::set<int> _threads;                     // thread tracks named so far
+    long _flowId = 0;
+
+    // reporter track - named when first used
+    int _reporterTrack(const traceRecord_t& record)
+    {
+        int tid = reporterTid(record);
+        if (_reporters.insert(tid).second)
+        {
+            _out.meta("thread_name", PID_REPORTERS, tid, reporterName(record));
+        }
+        return(tid);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: dawsTraceExport <capture.bin> > trace.json" << std::endl;
+        return(2);
+    }
+    TraceFile capture;
+    if (!capture.open(argv[1]))
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return(2);
+    }
+    if (capture.getChunks().empty())
+    {
+        std::cerr << "no trace chunks found" << std::endl;
+        return(1);
+    }
+    {
+        Writer out(stdout);
+        Exporter exporter(out, capture.getNames());
+        std::vector<traceRecord_t> records;
+        for (const TraceChunk& chunk : capture.getChunks())
+        {
+            records.clear();
+            if (!TraceFile::decode(chunk, &records))
+            {
+                std::cerr << "chunk " << chunk.seq << " not valid" << std::endl;
+            }
+            for (const traceRecord_t& record : records)
+            {
+                exporter.add(record);
+            }
+        }
+    }
+    fprintf(stderr, "%zu chunks, %llu records, %llu lost on target, %llu chunks missing\n",
+            capture.getChunks().size(), (unsigned long long)capture.getRecordCount(),
+            (unsigned long long)capture.getLost(), (unsigned long long)capture.getMissing());
+    return(0);
+}
@@ -0,0 +1,410 @@
+/**
+@file dawsTraceFile.h
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.b
+
+@brief Trace capture reader
+
+ Shared by the host trace tools.  A capture is the raw serial output holding dumps written by
+ Trace::dump() and chunks streamed by Trace::stream() (src/dawsTraceFormat.h), possibly with other text
+ between them.  The capture is memory mapped and its chunks indexed.  Each chunk may be decoded on its
+ own, so chunks may be decoded in parallel.
+
+ Chunks sent more than once (e.g. streamed then dumped) are read once.  A chunk dumped while it was being
+ filled and later streamed when full is sent with fewer records first, so the copy with most records is read.  Chunks are ordered by session,
+ in the order sessions first appear, then by sequence number.  Times are micros() which wraps every
+ 71 minutes, so times are compared by signed difference and unwrapped assuming successive records are less
+ than 35 minutes apart.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.b Chunked compressed encoding
+//
+
+#ifndef ____dawsTraceFile__
+#define ____dawsTraceFile__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../src/dawsTraceFormat.h"
+
+/**
+ @brief Read little endian value
+
+ @param p - pointer to first byte
+ @param size - number of bytes (up to 4)
+
+ @return value
+ */
+static inline uint32_t traceReadLe(const uint8_t* p, int size)
+{
+    uint32_t value = 0;
+    for (int i = size - 1; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return(value);
+}
+
+/**
+ @brief Time difference
+
+ @param later - later time - micros()
+ @param earlier - earlier time - micros()
+
+ @return later - earlier allowing for wrap, negative if later is before earlier
+ */
+static inline int32_t traceDiff(uint32_t later, uint32_t earlier)
+{
+    return((int32_t)(later - earlier));
+}
+
+/**
+ @brief Time unwrapper
+
+ Extends 32 bit micros() to 64 bits by taking each time as the nearest to the previous one.
+ */
+class TraceUnwrapper
+{
+public:
+    int64_t unwrap(uint32_t t)
+    {
+        if (!_started)
+        {
+            _last = t;
+            _started = true;
+        }
+        _last += traceDiff(t, (uint32_t)_last);
+        return(_last);
+    }
+
+private:
+    bool _started = false;
+    int64_t _last = 0;
+};
+
+/**
+ @brief Chunk as found in the capture
+ */
+struct TraceChunk
+{
+    const uint8_t* data;    ///< encoded records
+    uint16_t bytes;         ///< encoded bytes
+    uint16_t count;         ///< records
+    uint32_t seq;           ///< sequence number in session
+    uint32_t session;       ///< recording session
+    uint32_t baseTime;      ///< time before first record
+    size_t order;           ///< session order in capture
+};
+
+/**
+ @brief Memory mapped trace capture
+ */
+class TraceFile
+{
+public:
+    ~TraceFile()
+    {
+        if (_data != nullptr)
+        {
+            munmap((void*)_data, _size);
+        }
+        if (_fd >= 0)
+        {
+            close(_fd);
+        }
+    }
+
+    /**
+     @brief Open capture
+
+     Map the capture and find the chunks in it.
+
+     @param path - capture file
+
+     @return true if opened.  There may be no chunks.
+     */
+    bool open(const char* path)
+    {
+        struct stat st;
+        _fd = ::open(path, O_RDONLY);
+        if (_fd < 0 || fstat(_fd, &st) != 0)
+        {
+            return(false);
+        }
+        _size = st.st_size;
+        if (_size > 0)
+        {
+            void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (p == MAP_FAILED)
+            {
+                return(false);
+            }
+            _data = (const uint8_t*)p;
+        }
+        _index();
+        return(true);
+    }
+
+    /**
+     @brief Get chunks
+     @return chunks in session and sequence order
+     */
+    const std::vector<TraceChunk>& getChunks() const
+    {
+        return(_chunks);
+    }
+
+    /**
+     @brief Get track names
+     @return names by track id - from all dumps
+     */
+    const std::map<int, std::string>& getNames() const
+    {
+        return(_names);
+    }
+
+    /**
+     @brief Get record count
+     @return records in all chunks
+     */
+    uint64_t getRecordCount() const
+    {
+        return(_records);
+    }
+
+    /**
+     @brief Get lost count
+     @return records overwritten on target before being sent, as last reported for each session
+     */
+    uint64_t getLost() const
+    {
+        uint64_t lost = 0;
+        for (const auto& l : _lost)
+        {
+            lost += l.second;
+        }
+        return(lost);
+    }
+
+    /**
+     @brief Get missing chunk count
+     @return chunks missing from the capture between the first and last of each session
+     */
+    uint64_t getMissing() const
+    {
+        return(_missing);
+    }
+
+    /**
+     @brief Get encoded size
+     @return bytes of chunks read, including headers
+     */
+    uint64_t getEncodedBytes() const
+    {
+        return(_encoded);
+    }
+
+    /**
+     @brief Does one chunk directly follow another
+
+     @param a - earlier chunk
+     @param b - later chunk
+
+     @return true if b follows a with none missing in between
+     */
+    static bool follows(const TraceChunk& a, const TraceChunk& b)
+    {
+        return(a.session == b.session && a.seq + 1 == b.seq);
+    }
+
+    /**
+     @brief Decode chunk
+
+     @param chunk - chunk
+     @param records - where the records are appended
+
+     @return false if the chunk could not be fully decoded
+     */
+    static bool decode(const TraceChunk& chunk, std::vector<traceRecord_t>* records)
+    {
+        traceCodec_t codec;
+        traceCodecReset(&codec, chunk.baseTime);
+        const uint8_t* p = chunk.data;
+        const uint8_t* end = chunk.data + chunk.bytes;
+        for (int i = 0; i < chunk.count; i++)
+        {
+            traceRecord_t record;
+            p = traceDecode(&codec, p, end, &record);
+            if (p == nullptr)
+            {
+                return(false);
+            }
+            records->push_back(record);
+        }
+        return(true);
+    }
+
+private:
+    int _fd = -1;                               // capture file
+    const uint8_t* _data = nullptr;             // mapped capture
+    size_t _size = 0;                           // capture size
+    std::vector<TraceChunk> _chunks;            // chunks found
+    std::map<int, std::string> _names;          // track names
+    std::map<uint32_t, uint32_t> _lost;         // lost by session
+    uint64_t _records = 0;                      // total records
+    uint64_t _missing = 0;                      // chunks missing
+    uint64_t _encoded = 0;                      // bytes of chunks
+
+    /*********************************
+     _dumpHeader
+     *********************************
+
+     Read a dump header and its track names.
+
+     returns size or 0 if not valid
+     *********************************/
+    size_t _dumpHeader(size_t pos)
+    {
+        const uint8_t* hp = _data + pos;
+        uint8_t version = hp[offsetof(traceDumpHeader_t, version)];
+        uint16_t nameCount = traceReadLe(hp + offsetof(traceDumpHeader_t, nameCount), 2);
+        size_t size = sizeof(traceDumpHeader_t) + nameCount * sizeof(traceName_t);
+        if (version != TRACE_VERSION || pos + size > _size)
+        {
+            return(0);
+        }
+        uint32_t session = traceReadLe(hp + offsetof(traceDumpHeader_t, session), 4);
+        uint32_t lost = traceReadLe(hp + offsetof(traceDumpHeader_t, lost), 4);
+        _lost[session] = std::max(_lost[session], lost);
+        for (int i = 0; i < nameCount; i++)
+        {
+            const uint8_t* np = hp + sizeof(traceDumpHeader_t) + i * sizeof(traceName_t);
+            const char* name = (const char*)np + offsetof(traceName_t, name);
+            _names[np[offsetof(traceName_t, id)]] = std::string(name, strnlen(name, TRACE_NAME_LEN));
+        }
+        return(size);
+    }
+
+    /*********************************
+     _chunk
+     *********************************
+
+     Read a chunk header and check the chunk.
+
+     returns size or 0 if not valid
+     *********************************/
+    size_t _chunk(size_t pos, TraceChunk* cp)
+    {
+        const uint8_t* hp = _data + pos;
+        cp->bytes = traceReadLe(hp + offsetof(traceChunkHeader_t, bytes), 2);
+        size_t size = sizeof(traceChunkHeader_t) + cp->bytes;
+        if (pos + size > _size)
+        {
+            return(0);
+        }
+        cp->data = hp + sizeof(traceChunkHeader_t);
+        if (traceCheck(cp->data, cp->bytes) != traceReadLe(hp + offsetof(traceChunkHeader_t, check), 2))
+        {
+            return(0);
+        }
+        cp->count = traceReadLe(hp + offsetof(traceChunkHeader_t, count), 2);
+        cp->seq = traceReadLe(hp + offsetof(traceChunkHeader_t, seq), 4);
+        cp->session = traceReadLe(hp + offsetof(traceChunkHeader_t, session), 4);
+        cp->baseTime = traceReadLe(hp + offsetof(traceChunkHeader_t, baseTime), 4);
+        return(size);
+    }
+
+    /*********************************
+     _index
+     *********************************
+
+     Find the dump headers and chunks.  Records are not decoded.
+     Of duplicate chunks the one with most records is kept, and the
+     chunks sorted.
+     *********************************/
+    void _index()
+    {
+        std::map<uint32_t, size_t> sessions;                        // session to order
+        std::map<std::pair<uint32_t, uint32_t>, size_t> seen;       // session, seq to index in chunks
+        size_t pos = 0;
+        while (pos + sizeof(traceChunkHeader_t) <= _size)
+        {
+            const void* hit = memchr(_data + pos, 'D', _size - pos);
+            if (hit == nullptr)
+            {
+                break;
+            }
+            pos = (const uint8_t*)hit - _data;
+            size_t size = 0;
+            TraceChunk chunk;
+            if (pos + sizeof(traceDumpHeader_t) <= _size && memcmp(_data + pos, TRACE_MAGIC, strlen(TRACE_MAGIC)) == 0)
+            {
+                size = _dumpHeader(pos);
+            }
+            else if (pos + sizeof(traceChunkHeader_t) <= _size &&
+                     memcmp(_data + pos, TRACE_CHUNK_SYNC, strlen(TRACE_CHUNK_SYNC)) == 0)
+            {
+                size = _chunk(pos, &chunk);
+                if (size > 0)
+                {
+                    auto s = sessions.insert(std::make_pair(chunk.session, sessions.size()));
+                    chunk.order = s.first->second;
+                    auto c = seen.insert(std::make_pair(std::make_pair(chunk.session, chunk.seq), _chunks.size()));
+                    if (c.second)
+                    {
+                        _chunks.push_back(chunk);
+                        _records += chunk.count;
+                        _encoded += size;
+                    }
+                    else if (chunk.count > _chunks[c.first->second].count)
+                    {
+                        // the earlier copy was sent before the chunk was full
+                        TraceChunk& kept = _chunks[c.first->second];
+                        _records += chunk.count - kept.count;
+                        _encoded += chunk.bytes - kept.bytes;
+                        kept = chunk;
+                    }
+                }
+            }
+            pos += (size > 0) ? size : 1;
+        }
+        std::sort(_chunks.begin(), _chunks.end(), [](const TraceChunk& a, const TraceChunk& b)
+        {
+            return(a.order != b.order ? a.order < b.order : a.seq < b.seq);
+        });
+        for (size_t i = 1; i < _chunks.size(); i++)
+        {
+            if (_chunks[i].session == _chunks[i - 1].session)
+            {
+                _missing += _chunks[i].seq - _chunks[i - 1].seq - 1;
+            }
+        }
+    }
+};
+
+#endif /* defined(____dawsTraceFile__) */
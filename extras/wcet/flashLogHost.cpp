@@ -0,0 +1,219 @@
+/**
+@file flashLogHost.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Persistent event log - host check
+
+ Runs FlashLog on a file backed store (host/dawsFileStore.h) and checks that records survive reboot,
+ wrap round the store in order, are found by boot and time and that no record is lost after a program
+ failure.
+
+ Build and run from the library root:
+
+     g++ -std=gnu++14 -O2 -pthread -Iextras/wcet/host -Isrc extras/wcet/flashLogHost.cpp \
+         extras/wcet/host/hostShim.cpp src/dawsReporter.cpp src/dawsLog.cpp src/dawsTrace.cpp \
+         src/dawsFlashLog.cpp -o flashLogHost
+     ./flashLogHost
+
+ The exit status is 1 if any check fails.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsFlashLog.h"
+#include "dawsFileStore.h"
+
+#define STORE_PATH "flashLogHost.img"   ///< store file - removed at start
+#define BLOCK_SIZE 1024                 ///< small blocks so the store wraps quickly
+#define BLOCK_COUNT 6
+
+static int failures = 0;
+
+/**
+ @brief Check a condition
+
+ @param ok - condition
+ @param what - description
+ */
+static void check(bool ok, const char* what)
+{
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/**
+ @brief Append records
+
+ @param first - value of the first record, the rest count up
+ @param count - number of records
+ @param syncEvery - records between syncs
+ */
+static void append(int first, int count, int syncEvery)
+{
+    logRecord_t record = {};
+    record.format = LOG_TEXT1;
+    record.argc = 1;
+    for (int i = 0; i < count; i++)
+    {
+        record.timeStamp = micros();
+        record.args[0] = first + i;
+        FlashLog::append(&record);
+        if (i % syncEvery == syncEvery - 1)
+        {
+            FlashLog::sync();
+        }
+    }
+    FlashLog::sync();
+}
+
+/**
+ @brief Read the log
+
+ @param boot - boot to read from
+ @param ordered - returns true if the records are in order of boot and time
+
+ @return values of the records from the boot
+ */
+static std::vector<int> readLog(uint16_t boot, bool* ordered)
+{
+    std::vector<int> values;
+    flashLogCursor_t cursor;
+    flashRecord_t record;
+    uint64_t last = 0;
+    *ordered = true;
+    if (!FlashLog::find(boot, 0, &cursor))
+    {
+        return(values);
+    }
+    while (FlashLog::read(&cursor, &record))
+    {
+        uint64_t key = flashKey(record.boot, record.time);
+        *ordered = *ordered && key >= last;
+        last = key;
+        values.push_back(record.args[0]);
+    }
+    return(values);
+}
+
+/**
+ @brief Find a value
+
+ @return true if the value is in the values
+ */
+static bool contains(const std::vector<int>& values, int value)
+{
+    for (int v : values)
+    {
+        if (v == value)
+        {
+            return(true);
+        }
+    }
+    return(false);
+}
+
+int main()
+{
+    bool ordered;
+    std::vector<int> values;
+    unlink(STORE_PATH);
+
+    // first boot
+    {
+        FileStore store(STORE_PATH, BLOCK_SIZE, BLOCK_COUNT);
+        check(FlashLog::begin(&store), "begin on erased store");
+        check(FlashLog::getBoot() == 1, "first boot is 1");
+        append(0, 100, 20);
+        values = readLog(0, &ordered);
+        bool all = values.size() == 100;
+        for (size_t i = 0; all && i < values.size(); i++)
+        {
+            all = (values[i] == (int)i);
+        }
+        check(all, "all records read back in order");
+
+        // a late record, older than one already written, is given that record's time
+        usleep(100000);
+        append(100, 1, 1);
+        logRecord_t late = {};
+        late.format = LOG_TEXT1;
+        late.argc = 1;
+        late.timeStamp = micros() - 50000;
+        late.args[0] = 101;
+        FlashLog::append(&late);
+        FlashLog::sync();
+        values = readLog(0, &ordered);
+        check(ordered && values.size() == 102 && values.back() == 101, "late record kept in time order");
+    }
+
+    // second boot - wraps round the store, then programs fail
+    {
+        FileStore store(STORE_PATH, BLOCK_SIZE, BLOCK_COUNT);
+        check(FlashLog::begin(&store), "begin after reboot");
+        check(FlashLog::getBoot() == 2, "boot counted up");
+        append(1000, 300, 16);
+        values = readLog(0, &ordered);
+        check(ordered, "records in order after wrap");
+        check(!values.empty() && values.back() == 1299, "latest record kept after wrap");
+        check(!contains(values, 0), "oldest records erased after wrap");
+        check(store.getErases() > BLOCK_COUNT, "blocks reused");
+        values = readLog(2, &ordered);
+        check(!values.empty() && values.front() >= 1000, "find by boot");
+
+        flashLogStats_t before;
+        flashLogStats_t after;
+        FlashLog::getStats(&before);
+        store.powerFail(10);        // part of the first record then nothing
+        append(5000, 3, 3);
+        append(5500, 3, 3);         // header of the next block fails
+        store.powerFail(-1);
+        FlashLog::sync();           // header retried
+        append(6000, 3, 3);
+        FlashLog::getStats(&after);
+        check(after.failed > before.failed, "program failures counted");
+        values = readLog(0, &ordered);
+        check(!contains(values, 5000), "failed records not read");
+        check(contains(values, 5500) && contains(values, 6002), "records after failure kept");
+    }
+
+    // third boot - nothing written after the failure may be lost
+    {
+        FileStore store(STORE_PATH, BLOCK_SIZE, BLOCK_COUNT);
+        check(FlashLog::begin(&store), "begin after failure");
+        check(FlashLog::getBoot() == 3, "boot counted up after failure");
+        append(7000, 3, 3);
+        values = readLog(0, &ordered);
+        check(ordered, "records in order after failure and reboot");
+        check(contains(values, 5502) && contains(values, 6000) && contains(values, 6002),
+              "records written after failure survive reboot");
+        check(contains(values, 7000) && contains(values, 7002), "new boot records read");
+    }
+
+    unlink(STORE_PATH);
+    printf("%d failed\n", failures);
+    return((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,172 @@
+/**
+@file governorHost.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Report queue pressure governor - host check
+
+ Drives Governor::update() with report queue peaks and checks that the pressure level is raised,
+ held and lowered as configured and that each governed reporter is given rate level
+ (pressure level - importance).
+
+ Build and run from the library root:
+
+     g++ -std=gnu++14 -O2 -pthread -Iextras/wcet/host -Isrc extras/wcet/governorHost.cpp \
+         extras/wcet/host/hostShim.cpp src/dawsReporter.cpp src/dawsLog.cpp src/dawsTrace.cpp \
+         src/dawsGovernor.cpp -o governorHost
+     ./governorHost
+
+ The exit status is 1 if any check fails.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdio>
+#include <vector>
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsGovernor.h"
+
+#define PEAK_MID ((GOVERNOR_LOW + GOVERNOR_HIGH) / 2)   ///< peak between the thresholds - level held
+
+/**
+ @brief Governed reporter
+
+ Records the rate levels it is given.
+ */
+class RateReporter: public Reporter
+{
+public:
+    RateReporter() : Reporter(WCET_REP)
+    {
+    }
+
+    ReporterType getType()
+    {
+        return(WCET_REP);
+    }
+
+    void setRateLevel(byte level)
+    {
+        levels.push_back(level);
+        Reporter::setRateLevel(level);
+    }
+
+    std::vector<byte> levels;   ///< rate levels given, in order
+};
+
+static RateReporter source;     // makes the reports that set the queue peak
+static RateReporter least;      // importance 0
+static RateReporter middle;     // importance 1
+static RateReporter most;       // importance 3
+static int failures = 0;
+
+/**
+ @brief Check a condition
+
+ @param ok - condition
+ @param what - description
+ */
+static void check(bool ok, const char* what)
+{
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/**
+ @brief Run governor periods
+
+ Fill the report queue to the peak and empty it before each update.
+
+ @param peak - report queue peak in each period
+ @param periods - number of periods
+
+ @return pressure level after the last period
+ */
+static byte run(int peak, int periods)
+{
+    report_t report;
+    byte level = Governor::getLevel();
+    for (int p = 0; p < periods; p++)
+    {
+        for (int i = 0; i < peak; i++)
+        {
+            source.queueReport(VL53_RANGE_CLOSE, i);  // critical - admitted up to the queue capacity
+        }
+        while (Reporter::tryGetReport(&report))
+        {
+        }
+        level = Governor::update();
+    }
+    return(level);
+}
+
+/**
+ @brief Compare rate levels
+
+ @param rp - reporter
+ @param expected - levels it should have been given, in order
+
+ @return true if the same
+ */
+static bool given(const RateReporter& rp, const std::vector<byte>& expected)
+{
+    return(rp.levels == expected);
+}
+
+int main()
+{
+    governorStats_t stats;
+    Reporter::takeQueuePeak();
+
+    check(Governor::add(&least, 0) && Governor::add(&middle, 1) && Governor::add(&most, 3), "reporters added");
+    check(least.levels.empty() && middle.levels.empty() && most.levels.empty(), "no change at level 0");
+
+    // raise
+    check(run(PEAK_MID, 5) == 0, "held at 0 between thresholds");
+    check(run(GOVERNOR_HIGH, 1) == 1, "raised at high threshold");
+    check(given(least, {1}) && given(middle, {}) && given(most, {}), "level 1 slows importance 0 only");
+    check(run(GOVERNOR_HIGH, 1) == 2, "raised again");
+    check(given(least, {1, 2}) && given(middle, {1}) && given(most, {}), "level 2 mapping");
+    check(run(REPORT_QUEUE_LEN, GOVERNOR_MAX_LEVEL) == GOVERNOR_MAX_LEVEL, "raised to maximum");
+    check(least.getRateLevel() == GOVERNOR_MAX_LEVEL && middle.getRateLevel() == GOVERNOR_MAX_LEVEL - 1
+          && most.getRateLevel() == GOVERNOR_MAX_LEVEL - 3, "maximum level mapping");
+
+    // hold
+    check(run(PEAK_MID, GOVERNOR_HOLD * 2) == GOVERNOR_MAX_LEVEL, "held between thresholds");
+    check(run(GOVERNOR_LOW, GOVERNOR_HOLD - 1) == GOVERNOR_MAX_LEVEL, "held until quiet for hold periods");
+    check(run(PEAK_MID, 1) == GOVERNOR_MAX_LEVEL, "held by a busier period");
+    check(run(GOVERNOR_LOW, GOVERNOR_HOLD - 1) == GOVERNOR_MAX_LEVEL, "quiet periods must be consecutive");
+
+    // lower
+    check(run(0, 1) == GOVERNOR_MAX_LEVEL - 1, "lowered after hold quiet periods");
+    check(run(0, GOVERNOR_HOLD * GOVERNOR_MAX_LEVEL) == 0, "lowered to 0");
+    check(given(least, {1, 2, 3, 4, 3, 2, 1, 0}), "importance 0 levels");
+    check(given(middle, {1, 2, 3, 2, 1, 0}), "importance 1 levels");
+    check(given(most, {1, 0}), "importance 3 levels");
+
+    Governor::getStats(&stats);
+    check(stats.raises == GOVERNOR_MAX_LEVEL && stats.lowers == GOVERNOR_MAX_LEVEL
+          && stats.maxLevel == GOVERNOR_MAX_LEVEL, "statistics");
+
+    printf("%d failed\n", failures);
+    return((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,135 @@
+/**
+@file Arduino.h
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Host shim for Arduino.h
+
+ The small part of the Arduino API used by the library's hot paths, so they may be built and
+ measured on the host by the execution time harness.  Not for use on target.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ____hostArduino__
+#define ____hostArduino__
+
+#include <chrono>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef uint8_t byte;
+
+#define A0 14   ///< analogue pins as Nano 33 BLE
+#define A1 15
+#define A2 16
+
+/**
+ @brief Microseconds since start
+
+ @return time in microseconds - wraps at 32 bits as on target
+ */
+inline unsigned long micros()
+{
+    return((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ @brief Milliseconds since start
+
+ @return time in milliseconds
+ */
+inline unsigned long millis()
+{
+    return(micros() / 1000);
+}
+
+/**
+ @brief Print
+
+ Output to stdout.
+ */
+class Print
+{
+public:
+    virtual ~Print()
+    {
+    }
+
+    virtual size_t write(uint8_t c)
+    {
+        return(fwrite(&c, 1, 1, stdout));
+    }
+
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        return(fwrite(buffer, 1, size, stdout));
+    }
+
+    size_t print(const char* s)
+    {
+        return(write((const uint8_t*)s, strlen(s)));
+    }
+
+    size_t print(char c)
+    {
+        return(write((uint8_t)c));
+    }
+
+    size_t print(unsigned long n)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%lu", n);
+        return(print(buffer));
+    }
+
+    size_t print(long n)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", n);
+        return(print(buffer));
+    }
+
+    size_t print(int n)
+    {
+        return(print((long)n));
+    }
+
+    size_t print(unsigned int n)
+    {
+        return(print((unsigned long)n));
+    }
+
+    size_t println(const char* s = "")
+    {
+        return(print(s) + print("\r\n"));
+    }
+
+    size_t println(unsigned long n)
+    {
+        return(print(n) + print("\r\n"));
+    }
+};
+
+extern Print Serial;   ///< stdout
+
+#endif /* defined(____hostArduino__) */
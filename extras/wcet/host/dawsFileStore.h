@@ -0,0 +1,202 @@
+/**
+@file dawsFileStore.h
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief File backed flash store
+
+ A FlashStore (src/dawsFlashStore.h) kept in a file so the flash event log may be run and tested on the
+ host, or a region read from the target examined.  It behaves as NOR flash: erase sets a block to the erase
+ value and programming can only clear bits, in whole program units.
+
+ powerFail() makes programming stop part way through, as if power were lost, to test recovery.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ____dawsFileStore__
+#define ____dawsFileStore__
+
+#include <cstdio>
+#include <vector>
+#include "dawsFlashStore.h"
+
+#define FILE_STORE_ERASED 0xff      ///< erase value
+
+/**
+ @brief File backed flash store
+ */
+class FileStore: public FlashStore
+{
+public:
+    /**
+     @brief Constructor
+
+     @param path - file - created erased if it does not exist
+     @param blockSize - block size in bytes, e.g. 4096 as the nRF52840
+     @param blockCount - number of blocks
+     @param programSize - program unit in bytes, e.g. 4 as the nRF52840
+     */
+    FileStore(const char* path, uint32_t blockSize, uint32_t blockCount, uint32_t programSize = 4) :
+        _path(path), _blockSize(blockSize), _blockCount(blockCount), _programSize(programSize)
+    {
+    }
+
+    ~FileStore()
+    {
+        if (_file != nullptr)
+        {
+            fclose(_file);
+        }
+    }
+
+    int init()
+    {
+        _file = fopen(_path, "r+b");
+        if (_file == nullptr)
+        {
+            _file = fopen(_path, "w+b");
+            if (_file == nullptr)
+            {
+                return(-1);
+            }
+        }
+        // extend to the full size, erased
+        fseek(_file, 0, SEEK_END);
+        long size = ftell(_file);
+        std::vector<uint8_t> erased(_blockSize, FILE_STORE_ERASED);
+        uint64_t at = size;
+        while (at < (uint64_t)_blockSize * _blockCount)
+        {
+            size_t length = _blockSize - at % _blockSize;     // to the next block boundary
+            if (fwrite(erased.data(), 1, length, _file) != length)
+            {
+                return(-1);
+            }
+            at += length;
+        }
+        return(fflush(_file));
+    }
+
+    uint32_t getBlockSize()
+    {
+        return(_blockSize);
+    }
+
+    uint32_t getBlockCount()
+    {
+        return(_blockCount);
+    }
+
+    uint32_t getProgramSize()
+    {
+        return(_programSize);
+    }
+
+    uint8_t getEraseValue()
+    {
+        return(FILE_STORE_ERASED);
+    }
+
+    int read(uint32_t address, void* buffer, uint32_t size)
+    {
+        if (!_inside(address, size) || fseek(_file, address, SEEK_SET) != 0)
+        {
+            return(-1);
+        }
+        return((fread(buffer, 1, size, _file) == size) ? 0 : -1);
+    }
+
+    int program(uint32_t address, const void* buffer, uint32_t size)
+    {
+        if (!_inside(address, size) || address % _programSize != 0 || size % _programSize != 0)
+        {
+            return(-1);
+        }
+        std::vector<uint8_t> data(size);
+        if (read(address, data.data(), size) != 0)
+        {
+            return(-1);
+        }
+        uint32_t count = size;
+        if (_failAfter >= 0 && (uint32_t)_failAfter < size)
+        {
+            count = _failAfter;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            data[i] &= ((const uint8_t*)buffer)[i];
+        }
+        fseek(_file, address, SEEK_SET);
+        fwrite(data.data(), 1, count, _file);
+        fflush(_file);
+        if (_failAfter >= 0)
+        {
+            _failAfter -= (count < size) ? _failAfter : size;
+            return((count < size) ? -1 : 0);
+        }
+        return(0);
+    }
+
+    int erase(uint32_t block)
+    {
+        if (block >= _blockCount)
+        {
+            return(-1);
+        }
+        std::vector<uint8_t> erased(_blockSize, FILE_STORE_ERASED);
+        fseek(_file, (long)block * _blockSize, SEEK_SET);
+        fwrite(erased.data(), 1, _blockSize, _file);
+        _erases++;
+        return(fflush(_file));
+    }
+
+    /**
+     @brief Simulate power failure
+
+     @param bytes - bytes programmed before programming stops.  Negative to program normally.
+     */
+    void powerFail(long bytes)
+    {
+        _failAfter = bytes;
+    }
+
+    /**
+     @brief Get erase count
+     @return blocks erased since constructed
+     */
+    uint32_t getErases() const
+    {
+        return(_erases);
+    }
+
+private:
+    const char* _path;
+    uint32_t _blockSize;
+    uint32_t _blockCount;
+    uint32_t _programSize;
+    FILE* _file = nullptr;
+    long _failAfter = -1;       // bytes before power fails - negative for never
+    uint32_t _erases = 0;
+
+    bool _inside(uint32_t address, uint32_t size) const
+    {
+        return(_file != nullptr && (uint64_t)address + size <= (uint64_t)_blockSize * _blockCount);
+    }
+};
+
+#endif /* defined(____dawsFileStore__) */
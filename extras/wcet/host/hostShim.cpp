@@ -0,0 +1,47 @@
+/**
+@file hostShim.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Host shim implementation
+
+ Critical section and Serial for the host build of the execution time harness.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <mutex>
+#include "Arduino.h"
+#include "mbed.h"
+
+Print Serial;
+
+/**
+ @brief Critical section lock
+
+ On target interrupts are disabled.  On host all threads are excluded.
+ */
+static std::recursive_mutex criticalSection;
+
+void core_util_critical_section_enter(void)
+{
+    criticalSection.lock();
+}
+
+void core_util_critical_section_exit(void)
+{
+    criticalSection.unlock();
+}
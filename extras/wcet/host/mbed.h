@@ -0,0 +1,414 @@
+/**
+@file mbed.h
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Host shim for mbed.h
+
+ The small part of the mbed API used by the library's hot paths, so they may be built and
+ measured on the host by the execution time harness.  Not for use on target.
+
+ Critical sections are a process wide recursive mutex.  Atomics are the GCC builtins.  Threads are
+ std::thread, ignoring priority and stack.  Tickers do not run, so ThreadStats records no samples.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ____hostMbed__
+#define ____hostMbed__
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ @brief Thread priorities as CMSIS-RTOS2
+ */
+typedef enum
+{
+    osPriorityNone = 0,
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48,
+    osPriorityISR = 56,
+    osPriorityError = -1
+} osPriority_t;
+
+typedef void* osThreadId_t;     ///< thread id - the rtos::Thread on host, nullptr for other threads
+
+inline osThreadId_t osThreadGetId()
+{
+    return(nullptr);
+}
+
+inline osPriority_t osThreadGetPriority(osThreadId_t)
+{
+    return(osPriorityNormal);
+}
+
+inline const char* osThreadGetName(osThreadId_t)
+{
+    return("host");
+}
+
+inline uint32_t osThreadGetStackSize(osThreadId_t)
+{
+    return(0);
+}
+
+inline uint32_t osThreadGetStackSpace(osThreadId_t)
+{
+    return(0);
+}
+
+#define MBED_BARRIER() __asm__ volatile("" ::: "memory")
+#define MBED_ALIGN(n) alignas(n)
+
+void core_util_critical_section_enter(void);
+void core_util_critical_section_exit(void);
+
+inline bool core_util_is_isr_active(void)
+{
+    return(false);  // no interrupts on host
+}
+
+inline uint8_t core_util_atomic_load_u8(const volatile uint8_t* p)
+{
+    return(__atomic_load_n(p, __ATOMIC_SEQ_CST));
+}
+
+inline uint16_t core_util_atomic_load_u16(const volatile uint16_t* p)
+{
+    return(__atomic_load_n(p, __ATOMIC_SEQ_CST));
+}
+
+inline uint32_t core_util_atomic_load_u32(const volatile uint32_t* p)
+{
+    return(__atomic_load_n(p, __ATOMIC_SEQ_CST));
+}
+
+inline bool core_util_atomic_load_bool(const volatile bool* p)
+{
+    return(__atomic_load_n(p, __ATOMIC_SEQ_CST));
+}
+
+inline void core_util_atomic_store_u8(volatile uint8_t* p, uint8_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+inline void core_util_atomic_store_u16(volatile uint16_t* p, uint16_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+inline void core_util_atomic_store_u32(volatile uint32_t* p, uint32_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+inline void core_util_atomic_store_bool(volatile bool* p, bool v)
+{
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+inline uint8_t core_util_atomic_exchange_u8(volatile uint8_t* p, uint8_t v)
+{
+    return(__atomic_exchange_n(p, v, __ATOMIC_SEQ_CST));
+}
+
+inline bool core_util_atomic_exchange_bool(volatile bool* p, bool v)
+{
+    return(__atomic_exchange_n(p, v, __ATOMIC_SEQ_CST));
+}
+
+inline uint32_t core_util_atomic_exchange_u32(volatile uint32_t* p, uint32_t v)
+{
+    return(__atomic_exchange_n(p, v, __ATOMIC_SEQ_CST));
+}
+
+inline uint8_t core_util_atomic_incr_u8(volatile uint8_t* p, uint8_t d)
+{
+    return(__atomic_add_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint16_t core_util_atomic_incr_u16(volatile uint16_t* p, uint16_t d)
+{
+    return(__atomic_add_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint32_t core_util_atomic_incr_u32(volatile uint32_t* p, uint32_t d)
+{
+    return(__atomic_add_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint8_t core_util_atomic_decr_u8(volatile uint8_t* p, uint8_t d)
+{
+    return(__atomic_sub_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint16_t core_util_atomic_decr_u16(volatile uint16_t* p, uint16_t d)
+{
+    return(__atomic_sub_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint32_t core_util_atomic_decr_u32(volatile uint32_t* p, uint32_t d)
+{
+    return(__atomic_sub_fetch(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline uint32_t core_util_atomic_fetch_add_u32(volatile uint32_t* p, uint32_t d)
+{
+    return(__atomic_fetch_add(p, d, __ATOMIC_SEQ_CST));
+}
+
+inline bool core_util_atomic_cas_u8(volatile uint8_t* p, uint8_t* expected, uint8_t desired)
+{
+    return(__atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+inline bool core_util_atomic_cas_u16(volatile uint16_t* p, uint16_t* expected, uint16_t desired)
+{
+    return(__atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+inline bool core_util_atomic_cas_u32(volatile uint32_t* p, uint32_t* expected, uint32_t desired)
+{
+    return(__atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+namespace mbed
+{
+/**
+ @brief NonCopyable as mbed
+ */
+template <typename T>
+class NonCopyable
+{
+protected:
+    NonCopyable() = default;
+    ~NonCopyable() = default;
+
+private:
+    NonCopyable(const NonCopyable&) = delete;
+    NonCopyable& operator=(const NonCopyable&) = delete;
+};
+
+/**
+ @brief Callback as mbed - function with an argument
+ */
+template <typename T>
+inline std::function<void()> callback(void (*fn)(T*), T* arg)
+{
+    return([fn, arg]() { fn(arg); });
+}
+
+/**
+ @brief Ticker as mbed
+
+ Does not run.
+ */
+class Ticker: NonCopyable<Ticker>
+{
+public:
+    void attach(void (*)(), std::chrono::microseconds)
+    {
+    }
+
+    void detach()
+    {
+    }
+};
+}
+
+namespace rtos
+{
+namespace Kernel
+{
+/**
+ @brief Kernel clock as mbed - millisecond ticks
+ */
+struct Clock
+{
+    using duration_u32 = std::chrono::duration<uint32_t, std::milli>;
+};
+
+constexpr Clock::duration_u32 wait_for_u32_forever(UINT32_MAX);    ///< wait forever
+}
+
+/**
+ @brief Mutex as mbed - recursive
+ */
+class Mutex: mbed::NonCopyable<Mutex>
+{
+public:
+    void lock()
+    {
+        _mutex.lock();
+    }
+
+    bool trylock()
+    {
+        return(_mutex.try_lock());
+    }
+
+    void unlock()
+    {
+        _mutex.unlock();
+    }
+
+private:
+    std::recursive_mutex _mutex;    ///< the mutex
+};
+
+/**
+ @brief Thread as mbed
+
+ The priority, stack and name are ignored.  The thread is detached when started.
+ */
+class Thread: mbed::NonCopyable<Thread>
+{
+public:
+    Thread(osPriority_t = osPriorityNormal, uint32_t = 0, unsigned char* = nullptr, const char* = nullptr)
+    {
+    }
+
+    int start(std::function<void()> fn)
+    {
+        std::thread(fn).detach();
+        return(0);
+    }
+
+    int set_priority(osPriority_t)
+    {
+        return(0);
+    }
+
+    osThreadId_t get_id()
+    {
+        return(this);
+    }
+};
+
+namespace ThisThread
+{
+inline void sleep_for(Kernel::Clock::duration_u32 time)
+{
+    std::this_thread::sleep_for(time);
+}
+
+inline void yield()
+{
+    std::this_thread::yield();
+}
+
+inline osThreadId_t get_id()
+{
+    return(osThreadGetId());
+}
+}
+
+/**
+ @brief Mail as mbed
+
+ A fixed pool of N items and a FIFO of pointers, both protected by the critical section.
+ try_get_for() does not wait.
+ */
+template <typename T, uint32_t N>
+class Mail: mbed::NonCopyable<Mail<T, N> >
+{
+public:
+    Mail(): _head(0), _tail(0)
+    {
+        for (uint32_t i = 0; i < N; i++)
+        {
+            _free[i] = &_items[i];
+        }
+        _freeCount = N;
+    }
+
+    T* try_alloc()
+    {
+        T* item = nullptr;
+        core_util_critical_section_enter();
+        if (_freeCount > 0)
+        {
+            item = _free[--_freeCount];
+        }
+        core_util_critical_section_exit();
+        return(item);
+    }
+
+    void put(T* item)
+    {
+        core_util_critical_section_enter();
+        _fifo[_tail++ % N] = item;
+        core_util_critical_section_exit();
+    }
+
+    T* try_get()
+    {
+        T* item = nullptr;
+        core_util_critical_section_enter();
+        if (_head != _tail)
+        {
+            item = _fifo[_head++ % N];
+        }
+        core_util_critical_section_exit();
+        return(item);
+    }
+
+    T* try_get_for(Kernel::Clock::duration_u32)
+    {
+        return(try_get());
+    }
+
+    int free(T* item)
+    {
+        core_util_critical_section_enter();
+        _free[_freeCount++] = item;
+        core_util_critical_section_exit();
+        return(0);
+    }
+
+    bool empty() const
+    {
+        return(_head == _tail);
+    }
+
+    bool full() const
+    {
+        return(_freeCount == 0);
+    }
+
+private:
+    T _items[N];        ///< pool
+    T* _free[N];        ///< free list
+    uint32_t _freeCount;    ///< number free
+    T* _fifo[N];        ///< queued items
+    uint32_t _head;     ///< next to get
+    uint32_t _tail;     ///< next to put
+};
+}
+
+#endif /* defined(____hostMbed__) */
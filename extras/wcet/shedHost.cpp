@@ -0,0 +1,189 @@
+/**
+@file shedHost.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Report class reserve - host check
+
+ Fills the report queue to the limit of each importance class and checks that reports of the class
+ are shed and counted while critical reports are still admitted up to the queue capacity, and that
+ each shed episode is logged once.
+
+ Build and run from the library root:
+
+     g++ -std=gnu++14 -O2 -pthread -Iextras/wcet/host -Isrc extras/wcet/shedHost.cpp \
+         extras/wcet/host/hostShim.cpp src/dawsReporter.cpp src/dawsLog.cpp src/dawsTrace.cpp -o shedHost
+     ./shedHost
+
+ The exit status is 1 if any check fails.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdio>
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+
+#define EVENT_LOW BLE_PEER_FOUND            ///< a CLASS_LOW event type
+#define EVENT_NORMAL SET_AUTO               ///< a CLASS_NORMAL event type
+#define EVENT_CRITICAL VL53_RANGE_CLOSE     ///< a CLASS_CRITICAL event type
+
+/**
+ @brief Reporter under test
+ */
+class ShedReporter: public Reporter
+{
+public:
+    ShedReporter() : Reporter(WCET_REP)
+    {
+    }
+
+    ReporterType getType()
+    {
+        return(WCET_REP);
+    }
+};
+
+static ShedReporter source;
+static int failures = 0;
+
+/**
+ @brief Check a condition
+
+ @param ok - condition
+ @param what - description
+ */
+static void check(bool ok, const char* what)
+{
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/**
+ @brief Empty the report queue
+
+ @return number of reports taken
+ */
+static int drain()
+{
+    report_t report;
+    int count = 0;
+    while (Reporter::tryGetReport(&report))
+    {
+        count++;
+    }
+    return(count);
+}
+
+/**
+ @brief Queue reports
+
+ @param repType - event type
+ @param count - number of reports
+
+ @return number of reports admitted, from the change in the shed count of the class
+ */
+static int queue(EventType repType, int count)
+{
+    ReportClass repClass = Reporter::getEventClass(repType);
+    uint32_t shed = Reporter::getShedCount(repClass);
+    for (int i = 0; i < count; i++)
+    {
+        source.queueReport(repType, i);
+    }
+    return(count - (int)(Reporter::getShedCount(repClass) - shed));
+}
+
+/**
+ @brief Count log records
+
+ Reads and so empties the log ring.
+
+ @param format - format to count
+ @param other - format also counted, returned in other count
+ @param otherCount - returns number of records with the other format
+
+ @return number of records with the format
+ */
+static int logged(logFormat_t format, logFormat_t other, int* otherCount)
+{
+    logRecord_t record;
+    int count = 0;
+    *otherCount = 0;
+    while (Log::read(&record))
+    {
+        if (record.format == format)
+        {
+            count++;
+        }
+        else if (record.format == other)
+        {
+            (*otherCount)++;
+        }
+    }
+    return(count);
+}
+
+int main()
+{
+    int full;
+    check(Reporter::getEventClass(EVENT_LOW) == CLASS_LOW && Reporter::getEventClass(EVENT_NORMAL) == CLASS_NORMAL
+          && Reporter::getEventClass(EVENT_CRITICAL) == CLASS_CRITICAL, "event classes");
+    drain();
+    logged(LOG_SHED, LOG_QUEUE_FULL, &full);
+
+    // low limit
+    check(queue(EVENT_CRITICAL, REPORT_LIMIT_LOW) == REPORT_LIMIT_LOW, "critical admitted to low limit");
+    check(queue(EVENT_LOW, 20) == 0, "low shed at low limit");
+    check(Reporter::getShedCount(CLASS_LOW) == 20, "low shed counted");
+    check(queue(EVENT_NORMAL, 1) == 1, "normal admitted above low limit");
+
+    // normal limit
+    check(queue(EVENT_CRITICAL, REPORT_LIMIT_NORMAL - REPORT_LIMIT_LOW - 1) == REPORT_LIMIT_NORMAL - REPORT_LIMIT_LOW - 1,
+          "critical admitted to normal limit");
+    check(queue(EVENT_NORMAL, 20) == 0, "normal shed at normal limit");
+    check(Reporter::getShedCount(CLASS_NORMAL) == 20, "normal shed counted");
+
+    // reserve
+    check(queue(EVENT_CRITICAL, REPORT_QUEUE_LEN - REPORT_LIMIT_NORMAL) == REPORT_QUEUE_LEN - REPORT_LIMIT_NORMAL,
+          "critical admitted to queue capacity");
+    check(queue(EVENT_CRITICAL, 5) == 0, "critical shed when full");
+    check(Reporter::getShedCount(CLASS_CRITICAL) == 5 && Reporter::getShedCount(CLASS_LOW) == 20
+          && Reporter::getShedCount(CLASS_NORMAL) == 20, "shed counted by class");
+    check(Reporter::getQueueFullCount() == 45, "total shed counted");
+    check(drain() == REPORT_QUEUE_LEN, "queue held capacity");
+
+    // logging
+    check(logged(LOG_SHED, LOG_QUEUE_FULL, &full) == 2 && full == 1, "each class episode logged once");
+    check(queue(EVENT_CRITICAL, REPORT_LIMIT_LOW) == REPORT_LIMIT_LOW && queue(EVENT_LOW, 50) == 0, "low shed again");
+    check(logged(LOG_SHED, LOG_QUEUE_FULL, &full) == 0, "episode continues until a low report is admitted");
+    drain();
+    check(queue(EVENT_LOW, 1) == 1, "low admitted after drain");
+    check(queue(EVENT_CRITICAL, REPORT_LIMIT_LOW - 1) == REPORT_LIMIT_LOW - 1 && queue(EVENT_LOW, 50) == 0,
+          "low shed in new episode");
+    check(queue(EVENT_NORMAL, 1) == 1, "normal admitted during low shed");
+    check(logged(LOG_SHED, LOG_QUEUE_FULL, &full) == 1 && full == 0, "new episode logged once");
+    drain();
+
+    printf("%d failed\n", failures);
+    return((failures == 0) ? 0 : 1);
+}
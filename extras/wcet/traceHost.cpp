@@ -0,0 +1,191 @@
+/**
+@file traceHost.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Trace recorder - host round trip check
+
+ Records spans with Trace, captures them with dump() and stream() as the serial output would be
+ captured, and reads the capture back with the host tools' reader (extras/tools/dawsTraceFile.h).  Every
+ record must be read back once, in order, with nothing reported lost or missing.
+
+ Build and run from the library root:
+
+     g++ -std=gnu++14 -O2 -pthread -Iextras/wcet/host -Isrc extras/wcet/traceHost.cpp \
+         extras/wcet/host/hostShim.cpp src/dawsReporter.cpp src/dawsLog.cpp src/dawsTrace.cpp -o traceHost
+     ./traceHost
+
+ The exit status is 1 if any check fails.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsTrace.h"
+#include "../tools/dawsTraceFile.h"
+
+#define CAPTURE_PATH "traceHost.bin"    ///< capture file - removed at exit
+#define STREAM_EVERY 40                 ///< records between stream() calls
+
+/**
+ @brief Capture output
+
+ Writes to the capture file, with text between the trace output as a serial capture would have.
+ */
+class CapturePrint: public Print
+{
+public:
+    size_t write(uint8_t c)
+    {
+        return(fwrite(&c, 1, 1, file));
+    }
+
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+        return(fwrite(buffer, 1, size, file));
+    }
+
+    FILE* file = nullptr;   ///< capture file
+};
+
+static CapturePrint capture;
+static std::vector<traceRecord_t> recorded;     // spans recorded this session
+static uint32_t spanTime;                       // start of next span
+static int failures = 0;
+
+/**
+ @brief Check a condition
+
+ @param ok - condition
+ @param what - description
+ */
+static void check(bool ok, const char* what)
+{
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/**
+ @brief Start session
+
+ Start recording and the capture.
+ */
+static void begin()
+{
+    recorded.clear();
+    capture.file = fopen(CAPTURE_PATH, "wb");
+    Trace::start();
+    spanTime = micros();
+}
+
+/**
+ @brief Record spans
+
+ Spans vary in length so the times do not all encode alike.
+
+ @param count - number of spans
+ @param stream - true to stream every STREAM_EVERY spans
+ */
+static void record(int count, bool stream)
+{
+    for (int i = 0; i < count; i++)
+    {
+        traceRecord_t span = {};
+        span.kind = TRACE_SPAN;
+        span.id = recorded.size() % 3;
+        span.time[0] = spanTime;
+        span.time[1] = spanTime + 10 + recorded.size() % 97;
+        spanTime += 100 + recorded.size() % 13;
+        Trace::span(span.id, span.time[0], span.time[1]);
+        recorded.push_back(span);
+        if (stream && recorded.size() % STREAM_EVERY == 0)
+        {
+            Trace::stream(capture);
+            capture.print("\r\nother output\r\n");
+        }
+    }
+}
+
+/**
+ @brief Read capture back and compare
+
+ @param what - scenario name
+
+ @return number of chunks read
+ */
+static size_t compare(const char* what)
+{
+    char text[80];
+    fclose(capture.file);
+    TraceFile file;
+    std::vector<traceRecord_t> records;
+    bool decoded = file.open(CAPTURE_PATH);
+    for (const TraceChunk& chunk : file.getChunks())
+    {
+        decoded = TraceFile::decode(chunk, &records) && decoded;
+    }
+    bool same = decoded && records.size() == recorded.size();
+    for (size_t i = 0; same && i < records.size(); i++)
+    {
+        same = records[i].kind == TRACE_SPAN && records[i].id == recorded[i].id &&
+               records[i].time[0] == recorded[i].time[0] && records[i].time[1] == recorded[i].time[1];
+    }
+    snprintf(text, sizeof(text), "%s: %zu of %zu records read back", what, records.size(), recorded.size());
+    check(same, text);
+    snprintf(text, sizeof(text), "%s: record count, lost and missing", what);
+    check(file.getRecordCount() == recorded.size() && file.getLost() == 0 && file.getMissing() == 0, text);
+    unlink(CAPTURE_PATH);
+    return(file.getChunks().size());
+}
+
+int main()
+{
+    // dump of a session that fits in the chunks held
+    begin();
+    record(300, false);
+    Trace::stop();
+    uint32_t dumped = Trace::dump(capture);
+    check(compare("dump") == dumped, "dump: chunks written counted");
+
+    // streamed session, longer than the chunks held - stop() lets the last partial chunk be sent
+    begin();
+    record(3000, true);
+    Trace::stop();
+    check(Trace::stream(capture) == 1, "stream: last chunk sent after stop");
+    check(Trace::stream(capture) == 0, "stream: last chunk sent once");
+    compare("stream");
+
+    // dump part way through a chunk then stream - the chunk is sent again when full
+    begin();
+    record(100, false);
+    Trace::dump(capture);
+    record(3000, true);
+    Trace::stop();
+    Trace::stream(capture);
+    compare("dump then stream");
+
+    printf("%d failed\n", failures);
+    return((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,133 @@
+/**
+@file wcetHost.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+
+@brief Execution time harness - host backend
+
+ Runs the library's execution time harness (Wcet::runHarness) on the host.  Contention is from
+ two producer threads queueing reports and publishing latest values and a consumer thread
+ draining the report queue.  The persistent log is begun on a file backed store so its staging path
+ is measured.
+
+ Build and run from the library root:
+
+     g++ -std=gnu++14 -O2 -pthread -Iextras/wcet/host -Isrc extras/wcet/wcetHost.cpp \
+         extras/wcet/host/hostShim.cpp src/dawsReporter.cpp src/dawsLog.cpp src/dawsTrace.cpp \
+         src/dawsLoopMonitor.cpp src/dawsPriority.cpp src/dawsThreadStats.cpp src/dawsWorkerPool.cpp \
+         src/dawsProfile.cpp src/dawsTelemetry.cpp src/dawsFlashLog.cpp src/dawsHeapGuard.cpp \
+         src/dawsWcet.cpp -o wcetHost
+     ./wcetHost > wcet.csv
+
+ Compare the CSV with a previous run to catch regressions.  Add -DHEAP_GUARD=true to check that no
+ measured path allocates from the heap; the exit status is then 1 if any does.  The target backend is the
+ wcetHarness example sketch.
+ */
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsFlashLog.h"
+#include "dawsFileStore.h"
+#include "dawsHeapGuard.h"
+#include "dawsWcet.h"
+
+#define PRODUCERS 2                 ///< number of contending producer threads
+#define STORE_PATH "wcetHost.img"   ///< persistent log store - removed at exit
+
+/**
+ @brief Contending reporter
+
+ Makes reports from the producer threads.
+ */
+class LoadReporter: public Reporter
+{
+public:
+    LoadReporter() : Reporter(WCET_REP)
+    {
+    }
+
+    ReporterType getType()
+    {
+        return(WCET_REP);
+    }
+};
+
+static LoadReporter loadReporter;
+static std::atomic<bool> running(false);
+static std::thread producers[PRODUCERS];
+static std::thread consumer;
+
+/**
+ @brief Contention control
+
+ Start or stop the producer and consumer threads.
+
+ @param harnessReporter - the harness's reporter.  Its latest value is published by the producers.
+ @param start - true to start, false to stop
+ */
+static void contention(Reporter* harnessReporter, bool start)
+{
+    if (start)
+    {
+        running = true;
+        for (int i = 0; i < PRODUCERS; i++)
+        {
+            producers[i] = std::thread([harnessReporter]()
+            {
+                int n = 0;
+                while (running)
+                {
+                    loadReporter.queueReport(SET_AUTO, n);
+                    harnessReporter->publishLatest(n++);
+                }
+            });
+        }
+        consumer = std::thread([]()
+        {
+            report_t report;
+            while (running)
+            {
+                Reporter::tryGetReport(&report);
+            }
+        });
+    }
+    else
+    {
+        running = false;
+        for (int i = 0; i < PRODUCERS; i++)
+        {
+            producers[i].join();
+        }
+        consumer.join();
+    }
+}
+
+int main()
+{
+    FileStore store(STORE_PATH, 4096, 4);
+    FlashLog::begin(&store);
+    HeapGuard::initComplete();  // backend objects made
+    uint32_t failures = Wcet::runHarness(Serial, contention);
+    unlink(STORE_PATH);
+    return((failures == 0) ? 0 : 1);
+}
@@ -181,6 +181,20 @@ typedef long FixPnt2408;
  *********************************/
 #define LP_FILTER(x, y, n) ((y) - (ROUND(y, n)) + (x))
 
+/**
+ @brief Constant initialisation
+
+ Marks a static that must be initialised at compile time rather than by a constructor
+ run before main, so it is valid whatever order translation units are initialised in.
+ Checked by the compiler from C++20.  The Nano 33 BLE core builds as gnu++14 where it
+ only documents the intent.
+ */
+#if __cplusplus >= 202002L
+#define DAWS_CONSTINIT constinit
+#else
+#define DAWS_CONSTINIT
+#endif
+
 /** @defgroup hwAssignments Pin assignments etc for various hardwired connections, peripherals etc.
 
  Pins are defined here but may be addressed directly.  They are defined in terms of
@@ -225,6 +239,11 @@ enum HWpin : byte
  @}
  */
 
+/**
+ @brief Default thread priorities
+
+ These are the defaults.  Use Priority::get() for the priority configured at start up.
+ */
 #define AUTO_PRIORITY osPriorityAboveNormal  ///< Automaton thread priority - uses I2C
 #define MOTOR_PRIORITY osPriorityHigh        ///< Motor control thread priority
 #define ODO_PRIORITY osPriorityHigh          ///< Odometer measurement thread priority
@@ -0,0 +1,70 @@
+//
+/**
+ @file dawsEventTypes.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+
+ @brief Event type table
+
+ The event types reported (dawsReporter.h).  The EventType enum is made from this table and the
+ host tools, e.g. extras/tools/dawsTraceExport.cpp, include it to name event types.  It must therefore
+ only use standard headers.
+
+ Each entry is EVENT_TYPE(id).  Add new entries at the end so existing ids, traces and telemetry
+ remain valid.  Each event type also needs an entry in the class table in dawsReporter.cpp.
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsEventTypes__
+#define ____dawsEventTypes__
+
+#define DAWS_EVENT_TYPES \
+    EVENT_TYPE(REPORT_OVERRUN)        /* previous report from this source has not been processed */ \
+    EVENT_TYPE(LOCO_STOP)             /* loco stopped */ \
+    EVENT_TYPE(VL53_RANGE_CLOSE)      /* distance read - below critical distance */ \
+    EVENT_TYPE(VL53_RANGE_NORMAL)     /* distance read - above critical distance */ \
+    EVENT_TYPE(VL53_OUT_OF_RANGE)     /* range read error indicating out of range */ \
+    EVENT_TYPE(VL53_ERR)              /* range read error indicating HW problem */ \
+    EVENT_TYPE(NTAG_NDEF)             /* NFC ULTRALIGHT (NTAG21x) found with NDEF content */ \
+    EVENT_TYPE(NTAG_NONDEF)           /* NFC ULTRALIGHT (NTAG21x) found - null NDEF */ \
+    EVENT_TYPE(MIFARE_C1K_FOUND)      /* NFC MIFARE CLASSIC 1K found */ \
+    EVENT_TYPE(MIFARE_DEP_FOUND)      /* DEP target found */ \
+    EVENT_TYPE(MIFARE_DEP_MSG)        /* DEP message received (either way) */ \
+    EVENT_TYPE(MIFARE_DEP_PASSIVE)    /* been found as a DEP passive target */ \
+    EVENT_TYPE(NFC_OTHER_FOUND)       /* NFC other recognised tag found */ \
+    EVENT_TYPE(NFC_TAG_TYPE_UNKNOWN)  /* NFC tag found - type unknown */ \
+    EVENT_TYPE(RA_DISCOVERED)         /* discovered Accessory for this remote */ \
+    EVENT_TYPE(RA_STATE_CHANGE)       /* remote accessory status update */ \
+    EVENT_TYPE(RA_CONNECTED)          /* remote accessory now connected */ \
+    EVENT_TYPE(RA_DISCONNECTED)       /* remote accessory disconnected */ \
+    EVENT_TYPE(BLE_SCAN_START)        /* BLE Scan started */ \
+    EVENT_TYPE(BLE_SCAN_DONE)         /* BLE Scan completed */ \
+    EVENT_TYPE(BLE_PEER_FOUND)        /* BLE peer found by scan */ \
+    EVENT_TYPE(BLE_CONNECTED)         /* BLE - client (central) connection to peer made but discovery/service init required */ \
+    EVENT_TYPE(BLE_SERVICES_AVAIL)    /* BLE - client (central) connection completely open - services ready */ \
+    EVENT_TYPE(BLE_CONNECT_FAIL)      /* BLE - client (central) connection open failed */ \
+    EVENT_TYPE(BLE_DISCONNECTED)      /* BLE - client (central) disconnected */ \
+    EVENT_TYPE(ACC_STATE_CHANGE)      /* local accessory status update */ \
+    EVENT_TYPE(ROTQ_ROT)              /* rotary switch rotation */ \
+    EVENT_TYPE(ROTQ_ERR)              /* rotary switch double change (error) */ \
+    EVENT_TYPE(SET_AUTO)              /* set Loco Driver Auto mode */ \
+    EVENT_TYPE(LOOP_OVERRUN)          /* periodic loop missed its deadline - info is lateness (us) */
+
+#endif /* defined(____dawsEventTypes__) */
@@ -0,0 +1,120 @@
+//
+/**
+ @file dawsFlashFormat.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+
+ @brief Flash event log layout
+
+ The block and record layout of the persistent event log (dawsFlashLog.h).  Used on the host with
+ a file backed store so it must only use standard headers.  All values are little endian.
+
+ The log region is divided into blocks, each one flash erase unit.  Each block is a
+ flashBlockHeader_t followed by as many flashRecord_t as fit.  Blocks are written in turn round the
+ region, so each is erased once per pass (wear levelling), and the oldest block is erased when the
+ region is full.  The header is programmed with the block's first records.
+
+ A slot whose bytes are all the erase value is unused.  Records are programmed in order so the first
+ unused slot is the end of the block.  A record whose check is wrong (e.g. power lost while
+ programming) is skipped.
+
+ Records are ordered by boot then time.  time is millis() which wraps after 49 days, so a boot is
+ assumed to be shorter than that.
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsFlashFormat__
+#define ____dawsFlashFormat__
+
+#include <stdint.h>
+#include "dawsLogFormats.h"
+
+#define FLASH_LOG_MAGIC "DFLB"  ///< block header
+#define FLASH_LOG_VERSION 1     ///< block layout version
+
+/**
+ @brief Block header
+ */
+typedef struct
+{
+    char magic[4];          ///< FLASH_LOG_MAGIC without terminator
+    uint8_t version;        ///< FLASH_LOG_VERSION
+    uint8_t recordSize;     ///< sizeof(flashRecord_t)
+    uint16_t boot;          ///< boot number of the first record
+    uint32_t seq;           ///< block sequence number - one more than the previous block written
+    uint32_t firstTime;     ///< time of the first record - millis()
+    uint32_t eraseCount;    ///< times the block has been erased, including for this use
+    uint16_t reserved;      ///< 0
+    uint16_t check;         ///< flashCheck() of the header before this field
+} flashBlockHeader_t;
+
+/**
+ @brief Record
+
+ A binary log record (dawsLogFormats.h) with the boot number and time it was logged.
+ */
+typedef struct
+{
+    uint32_t time;              ///< time logged - millis()
+    uint16_t boot;              ///< boot number
+    uint8_t format;             ///< format id - logFormat_t
+    uint8_t argc;               ///< number of arguments
+    int32_t args[LOG_MAX_ARGS]; ///< arguments - unused are 0
+    uint16_t reserved;          ///< 0
+    uint16_t check;             ///< flashCheck() of the record before this field
+} flashRecord_t;
+
+/**
+ @brief Check value
+
+ Fletcher-16.
+
+ @param p - data
+ @param length - number of bytes
+
+ @return check value
+ */
+static inline uint16_t flashCheck(const void* p, uint32_t length)
+{
+    const uint8_t* bp = (const uint8_t*)p;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        a = (a + bp[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return((uint16_t)(b << 8 | a));
+}
+
+/**
+ @brief Order key
+
+ @param boot - boot number
+ @param time - millis()
+
+ @return key increasing with boot then time
+ */
+static inline uint64_t flashKey(uint16_t boot, uint32_t time)
+{
+    return(((uint64_t)boot << 32) | time);
+}
+
+#endif /* defined(____dawsFlashFormat__) */
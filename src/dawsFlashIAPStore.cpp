@@ -0,0 +1,138 @@
+/**
+@file dawsFlashIAPStore.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsFlashIAPStore.h"
+
+/**
+ @brief Constructor
+
+ @param address - start of region - sector aligned
+ @param size - size of region in bytes - a whole number of sectors
+ */
+FlashIAPStore::FlashIAPStore(uint32_t address, uint32_t size) : _address(address), _size(size), _blockSize(0)
+{
+}
+
+/**
+ @brief Initialise
+
+ @return 0 if the flash is ready and the region is inside it, sector aligned and of one sector size
+ */
+int FlashIAPStore::init()
+{
+    int rc = _flash.init();
+    if (rc != 0)
+    {
+        return(rc);
+    }
+    _blockSize = _flash.get_sector_size(_address);
+    if (_blockSize == 0 || _address < _flash.get_flash_start() ||
+        _address + _size > _flash.get_flash_start() + _flash.get_flash_size() ||
+        _address % _blockSize != 0 || _size % _blockSize != 0 ||
+        _flash.get_sector_size(_address + _size - 1) != _blockSize)
+    {
+        return(-1);
+    }
+    return(0);
+}
+
+/**
+ @brief Get block size
+ @return sector size in bytes
+ */
+uint32_t FlashIAPStore::getBlockSize()
+{
+    return(_blockSize);
+}
+
+/**
+ @brief Get block count
+ @return sectors in the region
+ */
+uint32_t FlashIAPStore::getBlockCount()
+{
+    return((_blockSize != 0) ? _size / _blockSize : 0);
+}
+
+/**
+ @brief Get program size
+ @return smallest unit that may be programmed
+ */
+uint32_t FlashIAPStore::getProgramSize()
+{
+    return(_flash.get_page_size());
+}
+
+/**
+ @brief Get erase value
+ @return value of erased bytes
+ */
+uint8_t FlashIAPStore::getEraseValue()
+{
+    return(_flash.get_erase_value());
+}
+
+/**
+ @brief Read
+
+ @param address - offset in region
+ @param buffer - where to read to
+ @param size - number of bytes
+
+ @return 0 if read
+ */
+int FlashIAPStore::read(uint32_t address, void* buffer, uint32_t size)
+{
+    return(_flash.read(buffer, _address + address, size));
+}
+
+/**
+ @brief Program
+
+ @param address - offset in region - a multiple of the program size
+ @param buffer - data
+ @param size - number of bytes - a multiple of the program size
+
+ @return 0 if programmed
+ */
+int FlashIAPStore::program(uint32_t address, const void* buffer, uint32_t size)
+{
+    return(_flash.program(buffer, _address + address, size));
+}
+
+/**
+ @brief Erase block
+
+ @param block - block number in region
+
+ @return 0 if erased
+ */
+int FlashIAPStore::erase(uint32_t block)
+{
+    return(_flash.erase(_address + block * _blockSize, _blockSize));
+}
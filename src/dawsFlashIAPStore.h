@@ -0,0 +1,62 @@
+//
+/**
+ @file dawsFlashIAPStore.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsFlashIAPStore__
+#define ____dawsFlashIAPStore__
+
+#include "dawsFlashStore.h"
+
+/**
+ @brief Internal flash store
+
+ A region of the microcontroller's own flash, through mbed::FlashIAP.  The region must be sector
+ aligned, have sectors of one size and not be used by the sketch, e.g. the top 64K of the
+ nRF52840's 1M:
+
+     FlashIAPStore store(0xF0000, 0x10000);
+
+ @note Programming and erasing stall the CPU while the flash is busy.  Call from a low priority thread.
+ */
+class FlashIAPStore: public FlashStore
+{
+public:
+    FlashIAPStore(uint32_t, uint32_t);
+    int init();
+    uint32_t getBlockSize();
+    uint32_t getBlockCount();
+    uint32_t getProgramSize();
+    uint8_t getEraseValue();
+    int read(uint32_t, void*, uint32_t);
+    int program(uint32_t, const void*, uint32_t);
+    int erase(uint32_t);
+
+private:
+    mbed::FlashIAP _flash;      // flash driver
+    uint32_t _address;          // start of region
+    uint32_t _size;             // size of region
+    uint32_t _blockSize;        // sector size
+};
+
+#endif /* defined(____dawsFlashIAPStore__) */
@@ -0,0 +1,638 @@
+/**
+@file dawsFlashLog.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsFlashLog.h"
+
+#define SLOT_EMPTY 0        ///< slot not programmed
+#define SLOT_VALID 1        ///< slot holds a record
+#define SLOT_BAD (-1)       ///< slot programmed but not valid
+
+/**
+ @brief Writer thread stack
+
+ Statically allocated so the thread does not take its stack from the heap.
+ */
+MBED_ALIGN(8) static unsigned char flashLogStack[FLASH_LOG_STACK_SIZE];
+
+FlashStore* FlashLog::_store = nullptr;
+flashRecord_t FlashLog::_stage[FLASH_LOG_STAGE_LEN];
+volatile uint32_t FlashLog::_head = 0;
+volatile uint32_t FlashLog::_tail = 0;
+uint32_t FlashLog::_lastTime = 0;
+bool FlashLog::_staged = false;
+uint32_t FlashLog::_blocks = 0;
+uint32_t FlashLog::_slots = 0;
+uint32_t FlashLog::_block = 0;
+uint32_t FlashLog::_seq = 0;
+uint32_t FlashLog::_slot = 0;
+uint32_t FlashLog::_used = 0;
+uint32_t FlashLog::_eraseCount = 0;
+bool FlashLog::_headerPending = false;
+uint16_t FlashLog::_boot = 0;
+flashLogStats_t FlashLog::_stats;
+rtos::Thread FlashLog::_thread(FLASH_LOG_PRIORITY, FLASH_LOG_STACK_SIZE, flashLogStack, "flashLog");
+
+/**
+ @brief Begin
+
+ Initialise the store and find the end of the log.  The boot number is one more than that of the
+ latest record.  Nothing is written until records are appended.
+
+ @param sp - store
+
+ @return true if ready.  False if the store could not be initialised or its program size does not
+ suit the layout.
+ */
+bool FlashLog::begin(FlashStore* sp)
+{
+    if (sp->init() != 0 || sp->getBlockCount() == 0 ||
+        sizeof(flashBlockHeader_t) % sp->getProgramSize() != 0 ||
+        sizeof(flashRecord_t) % sp->getProgramSize() != 0 ||
+        sp->getBlockSize() < sizeof(flashBlockHeader_t) + sizeof(flashRecord_t))
+    {
+        return(false);
+    }
+    _store = sp;
+    _blocks = sp->getBlockCount();
+    _slots = (sp->getBlockSize() - sizeof(flashBlockHeader_t)) / sizeof(flashRecord_t);
+
+    // the newest and oldest blocks from their headers
+    flashBlockHeader_t header;
+    bool any = false;
+    uint32_t newest = 0;
+    uint32_t oldestSeq = 0;
+    for (uint32_t b = 0; b < _blocks; b++)
+    {
+        if (!_readHeader(b, &header))
+        {
+            continue;
+        }
+        if (!any || (int32_t)(header.seq - _seq) > 0)
+        {
+            newest = b;
+            _seq = header.seq;
+            _boot = header.boot;
+        }
+        if (!any || (int32_t)(header.seq - oldestSeq) < 0)
+        {
+            oldestSeq = header.seq;
+        }
+        any = true;
+    }
+    _headerPending = false;
+    _staged = false;
+    if (!any)
+    {
+        // empty store - the first record starts block 0
+        _block = _blocks - 1;
+        _seq = (uint32_t)-1;
+        _slot = _slots;
+        _used = 0;
+        _boot = 1;
+        return(true);
+    }
+    _block = newest;
+    _used = (_seq - oldestSeq < _blocks) ? _seq - oldestSeq + 1 : _blocks;
+
+    // the end of the newest block, after its last slot that is not empty, and the latest boot in it
+    flashRecord_t record;
+    _slot = 0;
+    for (uint32_t slot = 0; slot < _slots; slot++)
+    {
+        int state = _readSlot(_block, slot, &record);
+        if (state == SLOT_EMPTY)
+        {
+            continue;
+        }
+        _slot = slot + 1;
+        if (state == SLOT_VALID && (int16_t)(record.boot - _boot) > 0)
+        {
+            _boot = record.boot;
+        }
+    }
+    _boot++;
+    return(true);
+}
+
+/**
+ @brief Start writer thread
+
+ Start the thread that programs the staged records.  It runs at FLASH_LOG_PRIORITY.
+
+ @note call after begin()
+ */
+void FlashLog::start()
+{
+    _thread.start(_run);
+}
+
+/**
+ @brief Append log record
+
+ Stage a binary log record, e.g. one taken from Log::read().  Its time is converted to millis().
+
+ @param lp - record
+
+ @return true if staged.  False if the staging buffer is full or the log not begun.
+
+ @note callable from ISR
+ */
+bool FlashLog::append(const logRecord_t* lp)
+{
+    uint32_t age = (micros() - lp->timeStamp) / 1000;
+    return(_stageRecord(millis() - age, lp->format, lp->argc, lp->args));
+}
+
+/**
+ @brief Append report
+
+ Stage a record of a report (LOG_REPORT), e.g. from the report handler for the events to be kept.
+ Its time is the event time.
+
+ @param rdp - report
+
+ @return true if staged.  False if the staging buffer is full or the log not begun.
+
+ @note callable from ISR
+ */
+bool FlashLog::report(const report_t* rdp)
+{
+    int32_t args[LOG_MAX_ARGS] = {rdp->source->getType(), rdp->source->getId(), rdp->repType, rdp->info};
+    uint32_t age = (micros() - rdp->timeStampEvent) / 1000;
+    return(_stageRecord(millis() - age, LOG_REPORT, 4, args));
+}
+
+/**
+ @brief Write staged records
+
+ Program the staged records in batches, starting new blocks as needed.  Called by the writer thread
+ but may be called directly, e.g. before a planned reset or on the host.
+
+ @return number of records written
+
+ @note Only one thread may write.  Not callable from ISR.
+ */
+uint32_t FlashLog::sync()
+{
+    flashRecord_t batch[FLASH_LOG_BATCH];
+    uint32_t written = 0;
+    if (_store == nullptr)
+    {
+        return(0);
+    }
+    while (true)
+    {
+        uint32_t tail = core_util_atomic_load_u32(&_tail);
+        uint32_t count = core_util_atomic_load_u32(&_head) - tail;
+        if (count == 0)
+        {
+            return(written);
+        }
+        if (_slot >= _slots && !_startBlock())
+        {
+            return(written);
+        }
+        if (count > FLASH_LOG_BATCH)
+        {
+            count = FLASH_LOG_BATCH;
+        }
+        if (count > _slots - _slot)
+        {
+            count = _slots - _slot;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            batch[i] = _stage[(tail + i) % FLASH_LOG_STAGE_LEN];
+            batch[i].check = flashCheck(&batch[i], offsetof(flashRecord_t, check));
+        }
+
+        uint32_t blockAddress = _block * _store->getBlockSize();
+        if (_headerPending)
+        {
+            flashBlockHeader_t header;
+            memcpy(header.magic, FLASH_LOG_MAGIC, sizeof(header.magic));
+            header.version = FLASH_LOG_VERSION;
+            header.recordSize = sizeof(flashRecord_t);
+            header.boot = batch[0].boot;
+            header.seq = _seq;
+            header.firstTime = batch[0].time;
+            header.eraseCount = _eraseCount;
+            header.reserved = 0;
+            header.check = flashCheck(&header, offsetof(flashBlockHeader_t, check));
+            if (_store->program(blockAddress, &header, sizeof(header)) != 0)
+            {
+                // block erased again so the header can be retried with the records still staged
+                _store->erase(_block);
+                core_util_critical_section_enter();
+                _stats.failed++;
+                core_util_critical_section_exit();
+                return(written);
+            }
+            _headerPending = false;
+        }
+        int rc = _store->program(blockAddress + sizeof(flashBlockHeader_t) + _slot * sizeof(flashRecord_t),
+                                 batch, count * sizeof(flashRecord_t));
+        core_util_critical_section_enter();
+        if (rc == 0)
+        {
+            _slot += count;
+            _stats.written += count;
+        }
+        else
+        {
+            _slot = _slots;     // abandon the block - no records after a partly programmed one
+            _stats.failed += count;
+        }
+        core_util_critical_section_exit();
+        core_util_atomic_store_u32(&_tail, tail + count);
+        written += count;
+    }
+}
+
+/**
+ @brief Find records by time
+
+ Set a cursor at the first record at or after the given boot and time.  The block is found by binary
+ search of the block headers, then the record by reading through the block.
+
+ @param boot - boot number
+ @param time - millis() in that boot
+ @param cp - where the cursor is returned
+
+ @return true if set.  False if the log is empty.  The cursor may be at the end of the log.
+ */
+bool FlashLog::find(uint16_t boot, uint32_t time, flashLogCursor_t* cp)
+{
+    if (_store == nullptr)
+    {
+        return(false);
+    }
+    core_util_critical_section_enter();
+    uint32_t seq = _seq;
+    uint32_t used = _used;
+    core_util_critical_section_exit();
+    if (used == 0)
+    {
+        return(false);
+    }
+
+    // last block starting at or before the time - headers are in order of seq
+    uint64_t key = flashKey(boot, time);
+    uint32_t low = seq - used + 1;
+    uint32_t high = seq;
+    uint32_t found = low;
+    flashBlockHeader_t header;
+    while ((int32_t)(high - low) >= 0)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t block = (_block + _blocks - (seq - mid) % _blocks) % _blocks;
+        if (!_readHeader(block, &header) || header.seq != mid)
+        {
+            if (mid == seq)
+            {
+                high = mid - 1;     // newest - header not yet programmed so no records
+            }
+            else
+            {
+                low = mid + 1;      // oldest - erased since the snapshot
+                found = low;
+            }
+            continue;
+        }
+        if (flashKey(header.boot, header.firstTime) <= key)
+        {
+            found = mid;
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    // first record at or after the time
+    cp->seq = found;
+    cp->slot = 0;
+    flashLogCursor_t at;
+    flashRecord_t record;
+    do
+    {
+        at = *cp;
+        if (!read(cp, &record))
+        {
+            *cp = at;
+            return(true);
+        }
+    } while (flashKey(record.boot, record.time) < key);
+    *cp = at;
+    return(true);
+}
+
+/**
+ @brief Read record
+
+ Read the record at the cursor and advance it.  Records not valid are skipped.  If the block under the
+ cursor has been erased the cursor moves to the oldest block.
+
+ @param cp - cursor - from find()
+ @param rp - where the record is returned
+
+ @return true if read.  False at the end of the log.
+ */
+bool FlashLog::read(flashLogCursor_t* cp, flashRecord_t* rp)
+{
+    if (_store == nullptr)
+    {
+        return(false);
+    }
+    while (true)
+    {
+        core_util_critical_section_enter();
+        uint32_t seq = _seq;
+        uint32_t used = _used;
+        uint32_t end = _slot;
+        uint32_t current = _block;
+        core_util_critical_section_exit();
+        uint32_t oldest = seq - used + 1;
+        if (used == 0 || (int32_t)(cp->seq - seq) > 0)
+        {
+            return(false);
+        }
+        if ((int32_t)(cp->seq - oldest) < 0)
+        {
+            cp->seq = oldest;
+            cp->slot = 0;
+        }
+        if (cp->slot >= ((cp->seq == seq) ? end : _slots))
+        {
+            if (cp->seq == seq)
+            {
+                return(false);
+            }
+            cp->seq++;
+            cp->slot = 0;
+            continue;
+        }
+        uint32_t block = (current + _blocks - (seq - cp->seq) % _blocks) % _blocks;
+        int state = _readSlot(block, cp->slot, rp);
+        cp->slot++;
+        core_util_critical_section_enter();
+        bool erased = (int32_t)(cp->seq - (_seq - _used + 1)) < 0;
+        core_util_critical_section_exit();
+        if (state == SLOT_VALID && !erased)
+        {
+            return(true);
+        }
+    }
+}
+
+/**
+ @brief Print records
+
+ Print the records from the given boot and time, one per line, as
+
+     <boot>:<time ms> <formatted text>
+
+ @param out - where to print, e.g. Serial
+ @param boot - boot number
+ @param time - millis() in that boot
+
+ @return number of records printed
+ */
+int FlashLog::print(Print& out, uint16_t boot, uint32_t time)
+{
+    flashLogCursor_t cursor;
+    flashRecord_t record;
+    char text[96];
+    int count = 0;
+    if (!find(boot, time, &cursor))
+    {
+        return(0);
+    }
+    while (read(&cursor, &record))
+    {
+        const char* format = Log::getFormat(record.format);
+        if (format == nullptr)
+        {
+            snprintf(text, sizeof(text), "unknown format %d", record.format);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), format, (int)record.args[0], (int)record.args[1],
+                     (int)record.args[2], (int)record.args[3]);
+        }
+        out.print((unsigned long)record.boot);
+        out.print(':');
+        out.print((unsigned long)record.time);
+        out.print(' ');
+        out.println(text);
+        count++;
+    }
+    return(count);
+}
+
+/**
+ @brief Get boot number
+
+ @return number given to records appended since begin()
+ */
+uint16_t FlashLog::getBoot()
+{
+    return(_boot);
+}
+
+/**
+ @brief Get statistics
+
+ @param sp - pointer to where the statistics are to be copied
+ */
+void FlashLog::getStats(flashLogStats_t* sp)
+{
+    core_util_critical_section_enter();
+    *sp = _stats;
+    core_util_critical_section_exit();
+}
+
+/*********************************
+ _stageRecord
+ *********************************
+
+ Add a record to the staging buffer under a critical section so the
+ times of staged records are in order.  A record older than the last
+ staged this boot is given that time, even if the last has already
+ been written.  Dropped and counted if the buffer is full.
+
+ parameters  - time, format id, argument count, arguments
+
+ returns true if staged
+ *********************************/
+bool FlashLog::_stageRecord(uint32_t time, byte format, byte argc, const int32_t* args)
+{
+    core_util_critical_section_enter();
+    uint32_t head = _head;
+    if (_store == nullptr || head - _tail >= FLASH_LOG_STAGE_LEN)
+    {
+        _stats.dropped++;
+        core_util_critical_section_exit();
+        return(false);
+    }
+    flashRecord_t* rp = &_stage[head % FLASH_LOG_STAGE_LEN];
+    if (_staged && (int32_t)(time - _lastTime) < 0)
+    {
+        time = _lastTime;   // keep the log in time order - a record may be older than one already staged
+    }
+    _lastTime = time;
+    _staged = true;
+    rp->time = time;
+    rp->boot = _boot;
+    rp->format = format;
+    rp->argc = argc;
+    for (int i = 0; i < LOG_MAX_ARGS; i++)
+    {
+        rp->args[i] = (i < argc) ? args[i] : 0;
+    }
+    rp->reserved = 0;
+    rp->check = 0;
+    _head = head + 1;
+    _stats.appended++;
+    core_util_critical_section_exit();
+    return(true);
+}
+
+/*********************************
+ _readHeader
+ *********************************
+
+ Read a block header and check it.
+
+ parameters  - block, where the header is returned
+
+ returns true if valid
+ *********************************/
+bool FlashLog::_readHeader(uint32_t block, flashBlockHeader_t* hp)
+{
+    return(_store->read(block * _store->getBlockSize(), hp, sizeof(*hp)) == 0 &&
+           memcmp(hp->magic, FLASH_LOG_MAGIC, sizeof(hp->magic)) == 0 &&
+           hp->version == FLASH_LOG_VERSION && hp->recordSize == sizeof(flashRecord_t) &&
+           hp->check == flashCheck(hp, offsetof(flashBlockHeader_t, check)));
+}
+
+/*********************************
+ _readSlot
+ *********************************
+
+ Read a record slot.
+
+ parameters  - block, slot, where the record is returned
+
+ returns SLOT_EMPTY if erased, SLOT_VALID or SLOT_BAD if the check
+ is wrong or it could not be read
+ *********************************/
+int FlashLog::_readSlot(uint32_t block, uint32_t slot, flashRecord_t* rp)
+{
+    uint32_t address = block * _store->getBlockSize() + sizeof(flashBlockHeader_t) + slot * sizeof(flashRecord_t);
+    if (_store->read(address, rp, sizeof(*rp)) != 0)
+    {
+        return(SLOT_BAD);
+    }
+    const uint8_t* bp = (const uint8_t*)rp;
+    uint8_t erased = _store->getEraseValue();
+    uint32_t i = 0;
+    while (i < sizeof(*rp) && bp[i] == erased)
+    {
+        i++;
+    }
+    if (i == sizeof(*rp))
+    {
+        return(SLOT_EMPTY);
+    }
+    return((rp->check == flashCheck(rp, offsetof(flashRecord_t, check))) ? SLOT_VALID : SLOT_BAD);
+}
+
+/*********************************
+ _startBlock
+ *********************************
+
+ Erase the next block round the store for the following records.  If
+ the store is full this is the oldest block.  Its header is programmed
+ with the first batch.
+
+ parameters  - none
+
+ returns true if erased
+ *********************************/
+bool FlashLog::_startBlock()
+{
+    uint32_t block = (_block + 1) % _blocks;
+    flashBlockHeader_t header;
+    uint32_t eraseCount = _readHeader(block, &header) ? header.eraseCount + 1 : 1;
+    core_util_critical_section_enter();
+    if (_used == _blocks)
+    {
+        _used--;    // readers move on from the oldest
+    }
+    core_util_critical_section_exit();
+    if (_store->erase(block) != 0)
+    {
+        core_util_critical_section_enter();
+        _stats.failed++;
+        core_util_critical_section_exit();
+        return(false);
+    }
+    core_util_critical_section_enter();
+    _block = block;
+    _seq++;
+    _slot = 0;
+    _used++;
+    _stats.erased++;
+    core_util_critical_section_exit();
+    _eraseCount = eraseCount;
+    _headerPending = true;
+    return(true);
+}
+
+/*********************************
+ _run
+ *********************************
+
+ Writer thread.  Program the staged records every FLASH_LOG_PERIOD ms.
+
+ parameters  - none
+
+ returns never
+ *********************************/
+void FlashLog::_run()
+{
+    while (true)
+    {
+        sync();
+        rtos::ThisThread::sleep_for(rtos::Kernel::Clock::duration_u32(FLASH_LOG_PERIOD));
+    }
+}
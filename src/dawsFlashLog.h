@@ -0,0 +1,134 @@
+//
+/**
+ @file dawsFlashLog.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsFlashLog__
+#define ____dawsFlashLog__
+
+#include "dawsFlashFormat.h"
+#include "dawsFlashStore.h"
+#include "dawsLogFormats.h"
+
+#ifndef FLASH_LOG_STAGE_LEN
+#define FLASH_LOG_STAGE_LEN 32          ///< records staged in RAM for the writer
+#endif
+#ifndef FLASH_LOG_BATCH
+#define FLASH_LOG_BATCH 8               ///< maximum records programmed at once
+#endif
+#ifndef FLASH_LOG_PERIOD
+#define FLASH_LOG_PERIOD 500            ///< writer period (ms)
+#endif
+#ifndef FLASH_LOG_STACK_SIZE
+#define FLASH_LOG_STACK_SIZE 1024       ///< writer thread stack size
+#endif
+#ifndef FLASH_LOG_PRIORITY
+#define FLASH_LOG_PRIORITY osPriorityLow    ///< writer thread priority
+#endif
+
+/**
+ @brief Flash log statistics
+ */
+typedef struct
+{
+    uint32_t appended;      ///< records staged
+    uint32_t written;       ///< records programmed
+    uint32_t dropped;       ///< records refused as the staging buffer was full
+    uint32_t erased;        ///< blocks erased
+    uint32_t failed;        ///< program or erase failures - the records are lost
+} flashLogStats_t;
+
+/**
+ @brief Read position
+ */
+typedef struct
+{
+    uint32_t seq;           ///< block sequence number
+    uint32_t slot;          ///< record slot in block
+} flashLogCursor_t;
+
+/**
+ @brief Persistent event log
+
+ An append only log in flash that survives reset, e.g. to find what led to a field incident.  Records
+ are binary log records (dawsLogFormats.h) stamped with the boot number and millis().  The layout is in
+ dawsFlashFormat.h.
+
+ begin() finds the end of the log in the store and the boot number.  Records are appended to a RAM
+ staging buffer, which is quick and callable from any context, so the report consumer is never
+ stalled by the flash.  The writer thread, started by start(), programs the staged records in batches every
+ FLASH_LOG_PERIOD ms.  If the staging buffer is full the record is dropped and counted.  Size
+ FLASH_LOG_STAGE_LEN for the highest rate expected over a period plus a block erase.
+
+ Blocks are used in turn round the store so the wear is even.  When the store is full the oldest block is
+ erased.  If programming records fails, e.g. at power failure, they are counted as failed and the rest of
+ the block is abandoned so no record is written after a hole.  If programming a block header fails the block
+ is erased again and the header retried at the next sync.
+
+ find() looks up a boot and time by binary search of the block headers.  read() then reads records in
+ order.
+
+ @note This is a static class.
+ */
+class FlashLog
+{
+public:
+    static bool begin(FlashStore*);
+    static void start();
+    static bool append(const logRecord_t*);
+    static bool report(const report_t*);
+    static uint32_t sync();
+
+    static bool find(uint16_t, uint32_t, flashLogCursor_t*);
+    static bool read(flashLogCursor_t*, flashRecord_t*);
+    static int print(Print&, uint16_t, uint32_t);
+
+    static uint16_t getBoot();
+    static void getStats(flashLogStats_t*);
+
+private:
+    static FlashStore* _store;                          // store - nullptr until begun
+    static flashRecord_t _stage[FLASH_LOG_STAGE_LEN];   // staging buffer
+    static volatile uint32_t _head;                     // next slot to stage - free running
+    static volatile uint32_t _tail;                     // next slot to write - free running
+    static uint32_t _lastTime;                          // time of the last record staged this boot
+    static bool _staged;                                // a record has been staged this boot
+    static uint32_t _blocks;                            // blocks in store
+    static uint32_t _slots;                             // record slots per block
+    static uint32_t _block;                             // current block
+    static uint32_t _seq;                               // current block sequence number
+    static uint32_t _slot;                              // next free slot in current block
+    static uint32_t _used;                              // blocks holding records
+    static uint32_t _eraseCount;                        // erase count for current block header
+    static bool _headerPending;                         // current block header not yet programmed
+    static uint16_t _boot;                              // boot number
+    static flashLogStats_t _stats;                      // statistics
+    static rtos::Thread _thread;                        // writer thread
+    static bool _stageRecord(uint32_t, byte, byte, const int32_t*);    // add to staging buffer
+    static bool _readHeader(uint32_t, flashBlockHeader_t*);         // read valid block header
+    static int _readSlot(uint32_t, uint32_t, flashRecord_t*);       // read record slot
+    static bool _startBlock();                                      // erase next block
+    static void _run();                                             // writer thread
+};
+
+#endif /* defined(____dawsFlashLog__) */
@@ -0,0 +1,51 @@
+//
+/**
+ @file dawsFlashStore.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsFlashStore__
+#define ____dawsFlashStore__
+
+/**
+ @brief Flash store
+
+ A region of flash divided into equal blocks, each an erase unit.  Addresses are offsets in the
+ region.  Functions return 0 on success, as mbed::FlashIAP.
+
+ The target store is FlashIAPStore (dawsFlashIAPStore.h).  On the host extras/wcet/host/dawsFileStore.h
+ keeps the region in a file.
+ */
+class FlashStore
+{
+public:
+    virtual int init() = 0;
+    virtual uint32_t getBlockSize() = 0;
+    virtual uint32_t getBlockCount() = 0;
+    virtual uint32_t getProgramSize() = 0;
+    virtual uint8_t getEraseValue() = 0;
+    virtual int read(uint32_t, void*, uint32_t) = 0;
+    virtual int program(uint32_t, const void*, uint32_t) = 0;
+    virtual int erase(uint32_t) = 0;
+};
+
+#endif /* defined(____dawsFlashStore__) */
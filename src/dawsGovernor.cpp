@@ -0,0 +1,190 @@
+/**
+@file dawsGovernor.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsGovernor.h"
+
+/**
+ @brief Governor thread stack
+
+ Statically allocated so the thread does not take its stack from the heap.
+ */
+MBED_ALIGN(8) static unsigned char governorStack[GOVERNOR_STACK_SIZE];
+
+Reporter* Governor::_reporters[GOVERNOR_MAX_REPORTERS];
+byte Governor::_importance[GOVERNOR_MAX_REPORTERS];
+byte Governor::_count = 0;
+byte Governor::_quiet = 0;
+governorStats_t Governor::_stats;
+rtos::Thread Governor::_thread(GOVERNOR_PRIORITY, GOVERNOR_STACK_SIZE, governorStack, "governor");
+
+/**
+ @brief Add reporter
+
+ Put a sampling reporter under the governor's control.  It is set to the rate level for the current
+ pressure level.
+
+ @param rp - reporter
+ @param importance - 0 to be slowed first, higher to be slowed later
+
+ @return false if GOVERNOR_MAX_REPORTERS have been added
+
+ @note Add reporters before start().
+ */
+bool Governor::add(Reporter* rp, byte importance)
+{
+    if (_count >= GOVERNOR_MAX_REPORTERS)
+    {
+        return(false);
+    }
+    _reporters[_count] = rp;
+    _importance[_count] = importance;
+    _count++;
+    _apply();
+    return(true);
+}
+
+/**
+ @brief Start governor thread
+
+ Start the thread calling update() every GOVERNOR_PERIOD ms.  It runs at GOVERNOR_PRIORITY, above the
+ sampling threads it governs.
+ */
+void Governor::start()
+{
+    _thread.start(_run);
+}
+
+/**
+ @brief Update pressure level
+
+ Take the report queue peak and raise, hold or lower the pressure level.  Reporters are only called if
+ the level changes.  Called by the governor thread, or periodically by the application if the thread is not
+ started.
+
+ @return pressure level
+ */
+byte Governor::update()
+{
+    byte peak = Reporter::takeQueuePeak();
+    _stats.peak = peak;
+    if (peak >= GOVERNOR_HIGH)
+    {
+        _quiet = 0;
+        if (_stats.level < GOVERNOR_MAX_LEVEL)
+        {
+            _stats.level++;
+            _stats.raises++;
+            if (_stats.level > _stats.maxLevel)
+            {
+                _stats.maxLevel = _stats.level;
+            }
+            Log::write(LOG_GOVERNOR, _stats.level, peak);
+            _apply();
+        }
+    }
+    else if (peak <= GOVERNOR_LOW && _stats.level > 0)
+    {
+        if (++_quiet >= GOVERNOR_HOLD)
+        {
+            _quiet = 0;
+            _stats.level--;
+            _stats.lowers++;
+            Log::write(LOG_GOVERNOR, _stats.level, peak);
+            _apply();
+        }
+    }
+    else
+    {
+        _quiet = 0;     // quiet periods must be consecutive
+    }
+    return(_stats.level);
+}
+
+/**
+ @brief Get pressure level
+
+ @return pressure level - 0 if all governed reporters are at full rate
+ */
+byte Governor::getLevel()
+{
+    return(_stats.level);
+}
+
+/**
+ @brief Get statistics
+
+ @param sp - where to copy the statistics
+ */
+void Governor::getStats(governorStats_t* sp)
+{
+    *sp = _stats;
+}
+
+/*********************************
+ _apply
+ *********************************
+
+ Set each governed reporter's rate level from the pressure level
+ and its importance.  Only reporters whose rate level changes are called.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+void Governor::_apply()
+{
+    for (byte i = 0; i < _count; i++)
+    {
+        byte rateLevel = (_stats.level > _importance[i]) ? _stats.level - _importance[i] : 0;
+        if (_reporters[i]->getRateLevel() != rateLevel)
+        {
+            _reporters[i]->setRateLevel(rateLevel);
+        }
+    }
+}
+
+/*********************************
+ _run
+ *********************************
+
+ Governor thread.  Update every GOVERNOR_PERIOD ms.
+
+ parameters  - none
+
+ returns never
+ *********************************/
+void Governor::_run()
+{
+    while (true)
+    {
+        update();
+        rtos::ThisThread::sleep_for(rtos::Kernel::Clock::duration_u32(GOVERNOR_PERIOD));
+    }
+}
@@ -0,0 +1,112 @@
+//
+/**
+ @file dawsGovernor.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsGovernor__
+#define ____dawsGovernor__
+
+#include "dawsReporter.h"
+
+#ifndef GOVERNOR_MAX_REPORTERS
+#define GOVERNOR_MAX_REPORTERS 8                ///< reporters that may be governed
+#endif
+#ifndef GOVERNOR_MAX_LEVEL
+#define GOVERNOR_MAX_LEVEL 4                    ///< highest pressure level
+#endif
+#ifndef GOVERNOR_HIGH
+#define GOVERNOR_HIGH (REPORT_LIMIT_LOW - 2)     ///< queue peak at or above which the level is raised
+#endif
+#ifndef GOVERNOR_LOW
+#define GOVERNOR_LOW (REPORT_QUEUE_LEN / 4)     ///< queue peak at or below which the level may be lowered
+#endif
+#ifndef GOVERNOR_HOLD
+#define GOVERNOR_HOLD 10                        ///< quiet periods before the level is lowered
+#endif
+#ifndef GOVERNOR_PERIOD
+#define GOVERNOR_PERIOD 100                     ///< governor period (ms)
+#endif
+#ifndef GOVERNOR_STACK_SIZE
+#define GOVERNOR_STACK_SIZE 768                 ///< governor thread stack size
+#endif
+#ifndef GOVERNOR_PRIORITY
+#define GOVERNOR_PRIORITY osPriorityAboveNormal ///< governor thread priority
+#endif
+
+#if GOVERNOR_LOW >= GOVERNOR_HIGH
+#error "GOVERNOR_LOW must be below GOVERNOR_HIGH"
+#endif
+
+/**
+ @brief Governor statistics
+ */
+typedef struct
+{
+    byte level;             ///< pressure level now
+    byte maxLevel;          ///< highest pressure level reached
+    byte peak;              ///< report queue peak in the last period
+    uint32_t raises;        ///< times the level was raised
+    uint32_t lowers;        ///< times the level was lowered
+} governorStats_t;
+
+/**
+ @brief Report queue pressure governor
+
+ Sheds load at source when the report queue is filling, rather than losing whichever reports
+ arrive when it is full.
+
+ Sampling reporters that can run slower, e.g. battery, BLE scan or rear VL53, are added with an importance.
+ Every GOVERNOR_PERIOD ms the governor takes the report queue peak (Reporter::takeQueuePeak()).  If it
+ is at or above GOVERNOR_HIGH, which is below the depth at which reports are shed, the pressure level is
+ raised by one.  Once the peak has stayed at or below GOVERNOR_LOW for GOVERNOR_HOLD periods the level is
+ lowered by one.  Between the two the level is held, so it does not oscillate.
+
+ Each reporter is set to rate level (pressure level - importance), or 0 if that is negative, by
+ Reporter::setRateLevel().  Importance 0 reporters are slowed first and most.  Reporters that must always run
+ at full rate are not added.
+
+ Level changes are logged (LOG_GOVERNOR).
+
+ @note This is a static class.
+ */
+class Governor
+{
+public:
+    static bool add(Reporter*, byte);
+    static void start();
+    static byte update();
+    static byte getLevel();
+    static void getStats(governorStats_t*);
+
+private:
+    static Reporter* _reporters[GOVERNOR_MAX_REPORTERS];    // governed reporters
+    static byte _importance[GOVERNOR_MAX_REPORTERS];        // their importance
+    static byte _count;                                     // number added
+    static byte _quiet;                                     // quiet periods at this level
+    static governorStats_t _stats;                          // statistics - includes level
+    static rtos::Thread _thread;                            // governor thread
+    static void _apply();                                   // set reporter rate levels
+    static void _run();                                     // governor thread
+};
+
+#endif /* defined(____dawsGovernor__) */
@@ -0,0 +1,329 @@
+/**
+@file dawsHeapGuard.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include <new>
+#include <stdlib.h>
+#include "dawsLog.h"
+#include "dawsHeapGuard.h"
+
+DAWS_CONSTINIT volatile bool HeapGuard::_complete = false;
+DAWS_CONSTINIT heapGuard_t HeapGuard::_stats = {};
+
+/**
+ @brief Initialisation complete
+
+ Called by the application when it has started all its reporters, threads and pools.  From now on
+ allocations are counted and logged.
+
+ @note This is a static function
+ */
+void HeapGuard::initComplete()
+{
+    core_util_atomic_store_bool(&_complete, true);
+}
+
+/**
+ @brief Is initialisation complete
+
+ @return true if initComplete() has been called
+ */
+bool HeapGuard::isComplete()
+{
+    return(core_util_atomic_load_bool(&_complete));
+}
+
+/**
+ @brief Get allocation count
+
+ @return allocations after init complete - 0 if HEAP_GUARD is false
+ */
+uint32_t HeapGuard::getCount()
+{
+    return(core_util_atomic_load_u32(&_stats.count));
+}
+
+/**
+ @brief Get statistics
+
+ @param sp - where to copy the statistics
+ */
+void HeapGuard::getStats(heapGuard_t* sp)
+{
+    core_util_critical_section_enter();
+    *sp = _stats;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Record allocation
+
+ Called by the replaced operator new.  Counted and logged if init is complete.
+
+ @param size - bytes requested
+ @param caller - return address of the caller of operator new
+ */
+void HeapGuard::allocated(size_t size, void* caller)
+{
+    if (!core_util_atomic_load_bool(&_complete))
+    {
+        return;
+    }
+    core_util_atomic_incr_u32(&_stats.count, 1);
+    core_util_atomic_incr_u32(&_stats.bytes, size);
+    _stats.lastCaller = caller;
+    Log::write(LOG_HEAP_ALLOC, (int)size, (int)(uintptr_t)caller);
+}
+
+/**
+ @brief Record free
+
+ Called by the replaced operator delete.  Counted if init is complete.
+ */
+void HeapGuard::freed()
+{
+    if (core_util_atomic_load_bool(&_complete))
+    {
+        core_util_atomic_incr_u32(&_stats.frees, 1);
+    }
+}
+
+#if HEAP_GUARD
+
+/*********************************
+ heapAllocate
+ *********************************
+
+ Allocate from the heap as the default operator new
+ and record the allocation.
+
+ parameters  - bytes requested, caller
+
+ returns memory or nullptr if the heap is exhausted
+ *********************************/
+static void* heapAllocate(size_t size, void* caller)
+{
+    HeapGuard::allocated(size, caller);
+    return(malloc(size == 0 ? 1 : size));
+}
+
+#if defined(__cpp_aligned_new)
+
+/*********************************
+ heapAllocateAligned
+ *********************************
+
+ Allocate from the heap as the default aligned operator new
+ and record the allocation.  aligned_alloc requires the size to
+ be a multiple of the alignment.
+
+ parameters  - bytes requested, alignment, caller
+
+ returns memory or nullptr if the heap is exhausted
+ *********************************/
+static void* heapAllocateAligned(size_t size, std::align_val_t align, void* caller)
+{
+    size_t alignment = static_cast<size_t>(align);
+    HeapGuard::allocated(size, caller);
+    size = (size == 0) ? alignment : (size + alignment - 1) / alignment * alignment;
+    return(aligned_alloc(alignment, size));
+}
+
+#endif
+
+/*********************************
+ heapRelease
+ *********************************
+
+ Free to the heap as the default operator delete
+ and record the free.
+
+ parameters  - memory - may be nullptr
+
+ returns none
+ *********************************/
+static void heapRelease(void* p)
+{
+    if (p != nullptr)
+    {
+        HeapGuard::freed();
+        free(p);
+    }
+}
+
+/*********************************
+ outOfMemory
+ *********************************
+
+ The throwing operator new must not return nullptr.  On target, where
+ exceptions are disabled, raise an mbed fatal error as the default
+ operator new does.  On host throw std::bad_alloc.
+
+ parameters  - bytes requested
+
+ returns never
+ *********************************/
+[[noreturn]] static void outOfMemory(size_t size)
+{
+#if defined(ARDUINO)
+    MBED_ERROR1(MBED_MAKE_ERROR(MBED_MODULE_APPLICATION, MBED_ERROR_CODE_OUT_OF_MEMORY), "operator new out of memory", size);
+#else
+    (void)size;
+    throw std::bad_alloc();
+#endif
+}
+
+// The replacement operators.  Only the nothrow forms return nullptr if the heap is exhausted.
+
+void* operator new(size_t size)
+{
+    void* p = heapAllocate(size, __builtin_return_address(0));
+    if (p == nullptr)
+    {
+        outOfMemory(size);
+    }
+    return(p);
+}
+
+void* operator new[](size_t size)
+{
+    void* p = heapAllocate(size, __builtin_return_address(0));
+    if (p == nullptr)
+    {
+        outOfMemory(size);
+    }
+    return(p);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return(heapAllocate(size, __builtin_return_address(0)));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return(heapAllocate(size, __builtin_return_address(0)));
+}
+
+void operator delete(void* p) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    heapRelease(p);
+}
+
+#if defined(__cpp_aligned_new)
+
+// The aligned forms, for types with an alignment above that of malloc.  Memory from aligned_alloc is
+// released by free.
+
+void* operator new(size_t size, std::align_val_t align)
+{
+    void* p = heapAllocateAligned(size, align, __builtin_return_address(0));
+    if (p == nullptr)
+    {
+        outOfMemory(size);
+    }
+    return(p);
+}
+
+void* operator new[](size_t size, std::align_val_t align)
+{
+    void* p = heapAllocateAligned(size, align, __builtin_return_address(0));
+    if (p == nullptr)
+    {
+        outOfMemory(size);
+    }
+    return(p);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return(heapAllocateAligned(size, align, __builtin_return_address(0)));
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return(heapAllocateAligned(size, align, __builtin_return_address(0)));
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    heapRelease(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    heapRelease(p);
+}
+
+#endif
+
+#endif
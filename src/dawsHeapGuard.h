@@ -0,0 +1,80 @@
+//
+/**
+ @file dawsHeapGuard.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsHeapGuard__
+#define ____dawsHeapGuard__
+
+#ifndef HEAP_GUARD
+#define HEAP_GUARD false    ///< Replace operator new and delete to count allocations after initComplete()
+#endif
+
+/**
+ @brief Heap guard statistics
+ */
+typedef struct
+{
+    uint32_t count;         ///< allocations after init complete
+    uint32_t bytes;         ///< bytes allocated after init complete
+    uint32_t frees;         ///< frees after init complete
+    void* lastCaller;       ///< return address of the last allocation after init complete
+} heapGuard_t;
+
+/**
+ @brief Heap guard
+
+ The report path and the library's components do not use the heap once started: queues, pools and
+ thread stacks are statically sized.  Heap use over a long session fragments the heap and has caused stalls.
+
+ If HEAP_GUARD is true the global operator new and delete are replaced by versions that use malloc and free
+ as the defaults do, but count every allocation and free after initComplete() is called.  When built as C++17
+ or later the aligned forms (std::align_val_t), used for over-aligned types, are replaced too and use
+ aligned_alloc.  Each such
+ allocation is also logged (LOG_HEAP_ALLOC) with its size and caller.  Tests, e.g. the execution time harness,
+ compare the count before and after each path and fail if it changes.  If the heap is exhausted the nothrow
+ operators return nullptr.  The others, as the defaults, never do: they raise an mbed fatal error on target and
+ throw std::bad_alloc on host.
+
+ If HEAP_GUARD is false the operators are not replaced and the counts stay 0.
+
+ @note Only C++ allocation is counted.  malloc called directly, e.g. by C library functions, is not.
+
+ @note This is a static class.
+ */
+class HeapGuard
+{
+public:
+    static void initComplete();
+    static bool isComplete();
+    static uint32_t getCount();
+    static void getStats(heapGuard_t*);
+    static void allocated(size_t, void*);
+    static void freed();
+
+private:
+    static volatile bool _complete;     // initComplete() called
+    static heapGuard_t _stats;          // statistics
+};
+
+#endif /* defined(____dawsHeapGuard__) */
@@ -0,0 +1,210 @@
+/**
+@file dawsLog.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsLog.h"
+
+/**
+ @brief Format strings indexed by format id
+ */
+static const char* const formats[LOG_FORMAT_COUNT] = {
+#define LOG_FMT(id, format) format,
+    DAWS_LOG_FORMATS
+#undef LOG_FMT
+};
+
+logRecord_t Log::_ring[LOG_RING_LEN];
+volatile uint8_t Log::_committed[LOG_RING_LEN];
+volatile uint32_t Log::_head = 0;
+volatile uint32_t Log::_tail = 0;
+volatile uint32_t Log::_drops = 0;
+
+/*********************************
+ _write
+ *********************************
+
+ Reserve a slot, fill it and mark it committed.  The head is advanced
+ by compare and swap so writers in threads and ISRs may interleave.  If
+ the ring is full the record is dropped and counted.
+
+ parameters  - format id, argument count, arguments
+
+ returns none
+ *********************************/
+void Log::_write(byte format, byte argc, int a, int b, int c, int d)
+{
+    uint32_t head = core_util_atomic_load_u32(&_head);
+    do
+    {
+        if (head - core_util_atomic_load_u32(&_tail) >= LOG_RING_LEN)
+        {
+            core_util_atomic_incr_u32(&_drops, 1);
+            return;
+        }
+    } while (!core_util_atomic_cas_u32(&_head, &head, head + 1));
+
+    uint32_t slot = head & (LOG_RING_LEN - 1);
+    logRecord_t* lp = &_ring[slot];
+    lp->timeStamp = micros();
+    lp->format = format;
+    lp->argc = argc;
+    lp->reserved = 0;
+    lp->args[0] = a;
+    lp->args[1] = b;
+    lp->args[2] = c;
+    lp->args[3] = d;
+    core_util_atomic_store_u8(&_committed[slot], 1);
+}
+
+/**
+ @brief Read record
+
+ Take the oldest record from the log.
+
+ @param lp - pointer to where the record is to be copied
+
+ @return true if a record was read, false if none is ready
+
+ @note Only one thread may read the log.
+ */
+bool Log::read(logRecord_t* lp)
+{
+    uint32_t tail = core_util_atomic_load_u32(&_tail);
+    uint32_t slot = tail & (LOG_RING_LEN - 1);
+    if (tail == core_util_atomic_load_u32(&_head) || !core_util_atomic_load_u8(&_committed[slot]))
+    {
+        return(false);
+    }
+    *lp = _ring[slot];
+    core_util_atomic_store_u8(&_committed[slot], 0);
+    core_util_atomic_store_u32(&_tail, tail + 1);
+    return(true);
+}
+
+/**
+ @brief Format log
+
+ Take all records ready from the log and print them, one per line, as
+
+     <time us> <formatted text>
+
+ @param out - where to print, e.g. Serial
+
+ @return number of records printed
+
+ @note Only one thread may read the log.  Call from a low priority thread.
+ */
+int Log::flush(Print& out)
+{
+    logRecord_t record;
+    char text[96];
+    int count = 0;
+    while (read(&record))
+    {
+        const char* format = getFormat(record.format);
+        if (format == nullptr)
+        {
+            snprintf(text, sizeof(text), "unknown format %d", record.format);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), format, (int)record.args[0], (int)record.args[1],
+                     (int)record.args[2], (int)record.args[3]);
+        }
+        out.print(record.timeStamp);
+        out.print(' ');
+        out.println(text);
+        count++;
+    }
+    return(count);
+}
+
+/**
+ @brief Dump log
+
+ Take all records ready from the log and write them in binary, preceded by a logDumpHeader_t, for
+ extras/tools/dawsLogDecode.cpp.  The header is written even if there are no records.
+
+ @param out - where to write, e.g. Serial
+
+ @return number of records written
+
+ @note Only one thread may read the log.  Call from a low priority thread.
+ */
+int Log::dump(Print& out)
+{
+    logDumpHeader_t header;
+    uint32_t tail = core_util_atomic_load_u32(&_tail);
+    uint32_t head = core_util_atomic_load_u32(&_head);
+    uint16_t count = 0;
+
+    // count committed records so the header is exact - later writes wait for the next dump
+    while (tail + count != head && _committed[(tail + count) & (LOG_RING_LEN - 1)])
+    {
+        count++;
+    }
+    memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+    header.version = LOG_VERSION;
+    header.count = count;
+    header.recordSize = sizeof(logRecord_t);
+    header.drops = getDropCount();
+    out.write((const uint8_t*)&header, sizeof(header));
+
+    logRecord_t record;
+    for (int i = 0; i < count; i++)
+    {
+        read(&record);
+        out.write((const uint8_t*)&record, sizeof(record));
+    }
+    return(count);
+}
+
+/**
+ @brief Get drop count
+
+ @return number of records dropped since start because the ring was full
+ */
+uint32_t Log::getDropCount()
+{
+    return(core_util_atomic_load_u32(&_drops));
+}
+
+/**
+ @brief Get format string
+
+ @param format - format id
+
+ @return format string or nullptr if the id is not known
+ */
+const char* Log::getFormat(byte format)
+{
+    if (format >= LOG_FORMAT_COUNT)
+    {
+        return(nullptr);
+    }
+    return(formats[format]);
+}
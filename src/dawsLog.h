@@ -0,0 +1,114 @@
+//
+/**
+ @file dawsLog.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsLog__
+#define ____dawsLog__
+
+#include "dawsLogFormats.h"
+
+#define LOG_RING_LEN 64     ///< log ring length - must be a power of 2
+
+/**
+ @brief Deferred binary log
+
+ A log callable from any context including ISRs.  A record holds only the time, the format id
+ (dawsLogFormats.h) and up to LOG_MAX_ARGS int arguments so it is cheap enough to leave enabled.
+
+ Writers reserve a slot by compare and swap on the ring head and set the slot's committed flag when
+ it is filled.  There are no locks.  If the ring is full the record is dropped and counted.
+
+ A single low priority thread reads the log.  flush() formats the records, dump() writes them in binary for
+ extras/tools/dawsLogDecode.cpp.  Either stops at a slot reserved but not yet committed.
+
+ @note This is a static class.
+ */
+class Log
+{
+public:
+    /**
+     @brief Log with no arguments
+     @param format - format id
+     */
+    static inline void write(logFormat_t format)
+    {
+        _write(format, 0, 0, 0, 0, 0);
+    }
+
+    /**
+     @brief Log with one argument
+     @param format - format id
+     @param a - argument
+     */
+    static inline void write(logFormat_t format, int a)
+    {
+        _write(format, 1, a, 0, 0, 0);
+    }
+
+    /**
+     @brief Log with two arguments
+     @param format - format id
+     @param a, b - arguments
+     */
+    static inline void write(logFormat_t format, int a, int b)
+    {
+        _write(format, 2, a, b, 0, 0);
+    }
+
+    /**
+     @brief Log with three arguments
+     @param format - format id
+     @param a, b, c - arguments
+     */
+    static inline void write(logFormat_t format, int a, int b, int c)
+    {
+        _write(format, 3, a, b, c, 0);
+    }
+
+    /**
+     @brief Log with four arguments
+     @param format - format id
+     @param a, b, c, d - arguments
+     */
+    static inline void write(logFormat_t format, int a, int b, int c, int d)
+    {
+        _write(format, 4, a, b, c, d);
+    }
+
+    static bool read(logRecord_t*);
+    static int flush(Print&);
+    static int dump(Print&);
+    static uint32_t getDropCount();
+    static const char* getFormat(byte);
+
+private:
+    static logRecord_t _ring[LOG_RING_LEN];             // records
+    static volatile uint8_t _committed[LOG_RING_LEN];   // slot filled and ready to read
+    static volatile uint32_t _head;                     // next slot to reserve - free running
+    static volatile uint32_t _tail;                     // next slot to read - free running
+    static volatile uint32_t _drops;                    // records dropped - ring full
+    static void _write(byte, byte, int, int, int, int); // add record
+};
+
+#endif /* defined(____dawsLog__) */
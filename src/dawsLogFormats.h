@@ -0,0 +1,97 @@
+//
+/**
+ @file dawsLogFormats.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+
+ @brief Binary log format table
+
+ The format strings of the binary log (dawsLog.h) and the record layout.  Only the format id is
+ logged.  The strings are used when the log is formatted, on the target by Log::flush() or on the
+ host by extras/tools/dawsLogDecode.cpp, which includes this file.  It must therefore only use
+ standard headers.
+
+ Each entry is LOG_FMT(id, format).  The format may use up to LOG_MAX_ARGS int conversions
+ (%d, %u, %x, %c).  Add new entries at the end so existing ids and logs remain valid.
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsLogFormats__
+#define ____dawsLogFormats__
+
+#include <stdint.h>
+
+#define LOG_MAX_ARGS 4          ///< maximum arguments per log record
+#define LOG_MAGIC "DAWSLOG"     ///< binary dump header
+#define LOG_VERSION 1           ///< binary dump version
+
+#define DAWS_LOG_FORMATS \
+    LOG_FMT(LOG_TEXT0,          "trace") \
+    LOG_FMT(LOG_TEXT1,          "trace %d") \
+    LOG_FMT(LOG_TEXT2,          "trace %d %d") \
+    LOG_FMT(LOG_TEXT4,          "trace %d %d %d %d") \
+    LOG_FMT(LOG_QUEUE_FULL,     "report queue full, reporter %c%d event %d") \
+    LOG_FMT(LOG_WORK_FULL,      "work queue %d full") \
+    LOG_FMT(LOG_LOOP_MISS,      "loop deadline missed by %uus") \
+    LOG_FMT(LOG_REPORT,         "report %c%d event %d info %d") \
+    LOG_FMT(LOG_GOVERNOR,       "queue governor level %d peak %d") \
+    LOG_FMT(LOG_HEAP_ALLOC,     "heap allocation of %u bytes after init from %x") \
+    LOG_FMT(LOG_SHED,           "shedding class %d reports, reporter %c%d event %d")
+
+/**
+ @brief Log format ids
+ */
+typedef enum
+{
+#define LOG_FMT(id, format) id,
+    DAWS_LOG_FORMATS
+#undef LOG_FMT
+    LOG_FORMAT_COUNT        ///< number of formats - must be last
+} logFormat_t;
+
+/**
+ @brief Log record
+
+ As held in the ring and written by Log::dump() (little endian).
+ */
+typedef struct
+{
+    uint32_t timeStamp;         ///< time logged - micros()
+    uint8_t format;             ///< format id
+    uint8_t argc;               ///< number of arguments
+    uint16_t reserved;          ///< for alignment
+    int32_t args[LOG_MAX_ARGS]; ///< arguments - unused are 0
+} logRecord_t;
+
+/**
+ @brief Binary dump header
+
+ Followed by count records.
+ */
+typedef struct
+{
+    char magic[7];              ///< LOG_MAGIC without terminator
+    uint8_t version;            ///< LOG_VERSION
+    uint16_t count;             ///< number of records following
+    uint16_t recordSize;        ///< sizeof(logRecord_t)
+    uint32_t drops;             ///< records dropped since start as the ring was full
+} logDumpHeader_t;
+
+#endif /* defined(____dawsLogFormats__) */
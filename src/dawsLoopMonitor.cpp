@@ -0,0 +1,230 @@
+/**
+@file dawsLoopMonitor.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsTrace.h"
+#include "dawsLoopMonitor.h"
+
+/**
+ @brief Construct loop monitor
+
+ @param name - name of loop monitored, e.g. "motor"
+ @param period - nominal period (us)
+ @param deadline - deadline relative to the nominal release of an iteration (us).  0 to use the period.
+ @param report - true if deadline misses are to be reported
+ */
+LoopMonitor::LoopMonitor(const char* name, unsigned long period, unsigned long deadline, bool report) : Reporter(LOOP_REP)
+{
+    _name = name;
+    _period = period;
+    _deadline = (deadline == 0) ? period : deadline;
+    _report = report;
+    _missing = false;
+    _started = false;
+    _resync = false;
+    _start = 0;
+    _release = 0;
+    resetStats();
+    Trace::nameTrack(getId(), name);
+}
+
+/**
+ @brief Get Reporter Type
+
+ @return reporter type identifier as an enum member.
+ */
+ReporterType LoopMonitor::getType()
+{
+    return(LOOP_REP);
+}
+
+/**
+ @brief Begin iteration
+
+ Called by the monitored thread at the start of each iteration.  The period since the
+ previous iteration began is recorded.
+
+ The nominal release of the iteration is the previous release plus the period.  If the iteration begins
+ early the release is when it began.  If it begins a whole period or more late it is measured from its
+ nominal release, so the lateness is recorded, but the next release is a period after this one began.
+ */
+void LoopMonitor::begin()
+{
+    unsigned long now = micros();
+    if (_started)
+    {
+        unsigned long period = now - _start;
+        unsigned long jitter = (period > _period) ? period - _period : _period - period;
+        int bin = (jitter == 0) ? 0 : 32 - __builtin_clz(jitter);
+        if (bin >= LOOP_HIST_BINS)
+        {
+            bin = LOOP_HIST_BINS - 1;
+        }
+        core_util_critical_section_enter();
+        _stats.jitter[bin]++;
+        if (period < _stats.minPeriod)
+        {
+            _stats.minPeriod = period;
+        }
+        if (period > _stats.maxPeriod)
+        {
+            _stats.maxPeriod = period;
+        }
+        core_util_critical_section_exit();
+        _release = _resync ? _start + _period : _release + _period;
+        if ((long)(now - _release) < 0)
+        {
+            _release = now;
+        }
+        _resync = (now - _release >= _period);
+    }
+    else
+    {
+        _release = now;
+    }
+    _start = now;
+    _started = true;
+}
+
+/**
+ @brief End iteration
+
+ Called by the monitored thread at the end of each iteration.  The execution time is recorded
+ and the response, from the nominal release, is checked against the deadline.
+ */
+void LoopMonitor::end()
+{
+    unsigned long now = micros();
+    unsigned long exec = now - _start;
+    unsigned long response = now - _release;
+    bool miss = response > _deadline;
+    core_util_critical_section_enter();
+    _stats.iterations++;
+    _stats.totalExec += exec;
+    if (exec > _stats.maxExec)
+    {
+        _stats.maxExec = exec;
+    }
+    if (miss)
+    {
+        _stats.misses++;
+        if (response - _deadline > _stats.worstLateness)
+        {
+            _stats.worstLateness = response - _deadline;
+        }
+    }
+    core_util_critical_section_exit();
+    if (miss && !_missing)
+    {
+        Log::write(LOG_LOOP_MISS, response - _deadline);
+        if (_report)
+        {
+            queueReport(LOOP_OVERRUN, response - _deadline);
+        }
+    }
+    _missing = miss;
+    Trace::span(getId(), _start, now);
+}
+
+/**
+ @brief Get statistics
+
+ @param sp - pointer to where the statistics are to be copied
+ */
+void LoopMonitor::getStats(loopStats_t* sp)
+{
+    core_util_critical_section_enter();
+    *sp = _stats;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Reset statistics
+ */
+void LoopMonitor::resetStats()
+{
+    core_util_critical_section_enter();
+    memset(&_stats, 0, sizeof(loopStats_t));
+    _stats.minPeriod = ~0UL;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Get name
+
+ @return name of loop monitored
+ */
+const char* LoopMonitor::getName()
+{
+    return(_name);
+}
+
+/**
+ @brief Get period
+
+ @return nominal period (us)
+ */
+unsigned long LoopMonitor::getPeriod()
+{
+    return(_period);
+}
+
+/**
+ @brief Print timing
+
+ Print a line for the schedulability report tool (extras/tools/dawsRta.cpp):
+
+     thread <name> <priority> <period> <wcet> <deadline>  # response <max>
+
+ The wcet must be the execution time without pre-emption, e.g. measured by the execution time harness
+ for the loop body.  The longest time measured from begin() to end() includes the time the loop was
+ pre-empted so it is not used as the wcet, as the analysis would count that interference twice.  It is
+ printed after # as the measured response, which the tool ignores, to compare with the analysed response.
+
+ @param out - where to print, e.g. Serial
+ @param priority - the monitored thread's priority
+ @param wcet - worst case execution time of an iteration without pre-emption (us)
+ */
+void LoopMonitor::printTiming(Print& out, osPriority_t priority, unsigned long wcet)
+{
+    loopStats_t stats;
+    getStats(&stats);
+    out.print("thread ");
+    out.print(_name);
+    out.print(' ');
+    out.print((int)priority);
+    out.print(' ');
+    out.print(_period);
+    out.print(' ');
+    out.print(wcet);
+    out.print(' ');
+    out.print(_deadline);
+    out.print("  # response ");
+    out.println(stats.maxExec);
+}
@@ -0,0 +1,93 @@
+//
+/**
+ @file dawsLoopMonitor.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsLoopMonitor__
+#define ____dawsLoopMonitor__
+
+#define LOOP_HIST_BINS 16   ///< number of jitter histogram bins
+
+/**
+ @brief Loop statistics
+
+ Jitter is the difference between the actual and nominal period.  The histogram holds
+ the absolute jitter in power of two bins.  Bin 0 is under 1us, bin n is from 2^(n-1) to 2^n - 1 us
+ and the last bin holds everything larger.
+ */
+typedef struct
+{
+    uint32_t iterations;            ///< number of iterations
+    uint32_t misses;                ///< iterations that ended after their deadline
+    unsigned long minPeriod;        ///< shortest period (us)
+    unsigned long maxPeriod;        ///< longest period (us)
+    unsigned long maxExec;          ///< longest time from begin() to end() including pre-emption (us)
+    uint64_t totalExec;             ///< total execution time (us) - for average
+    unsigned long worstLateness;    ///< latest an iteration has ended after its deadline from its nominal release (us)
+    uint32_t jitter[LOOP_HIST_BINS]; ///< period jitter histogram
+} loopStats_t;
+
+/**
+ @brief Periodic loop monitor
+
+ A periodic thread, e.g. motor control or odometer, calls begin() at the start and end() at
+ the end of each iteration.  The monitor records the period, jitter, execution time and
+ deadline misses.  An iteration misses its deadline if it ends more than the deadline after its nominal
+ release, the previous release plus the period, so a late start counts against it.  The thread should
+ wait for its next release with a sleep until the nominal release rather than a sleep for the period, as the
+ latter drifts.
+
+ If reporting is enabled the first miss of a run of misses is reported as LOOP_OVERRUN with the
+ lateness in the report info.  Only the first is reported so a loop that is persistently late does not
+ flood the report queue.
+
+ This is a reporter so it may be found by cycling through the reporters.
+ */
+class LoopMonitor: public Reporter
+{
+public:
+    LoopMonitor(const char*, unsigned long, unsigned long, bool);
+    ReporterType getType();
+
+    void begin();
+    void end();
+    void getStats(loopStats_t*);
+    void resetStats();
+    const char* getName();
+    unsigned long getPeriod();
+    void printTiming(Print&, osPriority_t, unsigned long);
+
+private:
+    const char* _name;          ///< name of loop monitored
+    unsigned long _period;      ///< nominal period (us)
+    unsigned long _deadline;    ///< deadline relative to nominal release (us)
+    bool _report;               ///< report misses
+    bool _missing;              ///< last iteration missed its deadline
+    bool _started;              ///< there has been a previous iteration
+    bool _resync;               ///< current iteration began a period late - next release from its start
+    unsigned long _start;       ///< start of current iteration
+    unsigned long _release;     ///< nominal release of current iteration
+    loopStats_t _stats;         ///< statistics
+};
+
+#endif /* defined(____dawsLoopMonitor__) */
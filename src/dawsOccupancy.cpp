@@ -0,0 +1,433 @@
+/**
+@file dawsOccupancy.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsOccupancy.h"
+
+#define BLOCK_WORD(b) ((b) >> 5)               ///< word in bitset holding block b
+#define BLOCK_BIT(b) (((uint32_t)1) << ((b) & 31)) ///< bit in word holding block b
+
+/**
+ @brief Construct occupancy model
+
+ All blocks are initially clear and unreserved.  No routes are defined and no tags or
+ reporters are bound to blocks.
+ */
+Occupancy::Occupancy()
+{
+    for (int i = 0; i < OCC_WORDS; i++)
+    {
+        _occupied[i] = 0;
+        _reserved[i] = 0;
+    }
+    for (int i = 0; i < OCC_MAX_BLOCKS; i++)
+    {
+        _blockRoutes[i] = 0;
+        _owner[i] = 0;
+    }
+    for (int i = 0; i < OCC_MAX_TAGS; i++)
+    {
+        _tagBlock[i] = OCC_NONE;
+    }
+    for (int i = 0; i < OCC_MAX_REPORTERS; i++)
+    {
+        _repBlock[i] = OCC_NONE;
+        _locoBlock[i] = OCC_NONE;
+    }
+    _routeClear = 0;
+    _routeCount = 0;
+    _routeHandler = nullptr;
+}
+
+/**
+ @brief Bind tag to block
+
+ Bind a track tag to the block in which it is located.  When a loco reads the tag it is
+ taken to have entered the block.
+
+ @param tag - tag number as reported in the info of an NTAG_NDEF report
+ @param block - block number
+ */
+void Occupancy::bindTag(byte tag, byte block)
+{
+    if (tag < OCC_MAX_TAGS && block < OCC_MAX_BLOCKS)
+    {
+        _tagBlock[tag] = block;
+    }
+}
+
+/**
+ @brief Bind reporter to block
+
+ Bind an accessory reporter (e.g. a remote track circuit) to a block.  Its RA_STATE_CHANGE
+ reports then set the occupancy of the block.
+
+ @param id - the reporter id
+ @param block - block number
+ */
+void Occupancy::bindReporter(byte id, byte block)
+{
+    if (id < OCC_MAX_REPORTERS && block < OCC_MAX_BLOCKS)
+    {
+        _repBlock[id] = block;
+    }
+}
+
+/**
+ @brief Add route
+
+ Define a route as a list of blocks.  The route's initial state is evaluated but the route
+ handler is not called.
+
+ @param blocks - array of block numbers
+ @param count - number of blocks in array
+
+ @return route index or OCC_NONE if there are too many routes.
+ */
+byte Occupancy::addRoute(const byte* blocks, byte count)
+{
+    if (_routeCount >= OCC_MAX_ROUTES)
+    {
+        return(OCC_NONE);
+    }
+    byte route = _routeCount++;
+    for (int i = 0; i < OCC_WORDS; i++)
+    {
+        _routeBlocks[route][i] = 0;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        byte b = blocks[i];
+        if (b < OCC_MAX_BLOCKS)
+        {
+            _routeBlocks[route][BLOCK_WORD(b)] |= BLOCK_BIT(b);
+            _blockRoutes[b] |= ((uint32_t)1) << route;
+        }
+    }
+    if (_routeFree(route))
+    {
+        _routeClear |= ((uint32_t)1) << route;
+    }
+    return(route);
+}
+
+/**
+ @brief Set route handler
+
+ The handler is called when a route changes between clear and not clear.
+
+ @param handler - the route handler or nullptr for none
+ */
+void Occupancy::setRouteHandler(routeHandler_t handler)
+{
+    _routeHandler = handler;
+}
+
+/**
+ @brief Process report
+
+ Update the model from a report taken from the report queue.  Reports that do not affect
+ occupancy are ignored.
+
+ @param rp - pointer to the report
+
+ @return true if the report was used to update the model.
+ */
+bool Occupancy::processReport(const report_t* rp)
+{
+    byte id = rp->source->getId();
+    if (id >= OCC_MAX_REPORTERS)
+    {
+        return(false);
+    }
+    switch (rp->repType)
+    {
+        case NTAG_NDEF:
+        {
+            if (rp->info < 0 || rp->info >= OCC_MAX_TAGS || _tagBlock[rp->info] == OCC_NONE)
+            {
+                return(false);  // not a tag bound to a block
+            }
+            byte block = _tagBlock[rp->info];
+            byte previous = _locoBlock[id];
+            if (previous == block)
+            {
+                return(false);  // read the same tag again
+            }
+            _locoBlock[id] = block;
+            occupy(block, id);
+            if (previous != OCC_NONE && _owner[previous] == id)
+            {
+                release(previous);  // loco has left the block it was in
+            }
+            return(true);
+        }
+
+        case RA_STATE_CHANGE:
+        {
+            byte block = _repBlock[id];
+            if (block == OCC_NONE)
+            {
+                return(false);  // not a block detector
+            }
+            byte owner = _owner[block];
+            if (rp->info != 0)
+            {
+                occupy(block, owner);   // a detector does not know the loco - keep any owner
+            }
+            else if (owner != 0 && owner < OCC_MAX_REPORTERS && _locoBlock[owner] == block)
+            {
+                return(false);  // a loco read a tag in the block - released when it reads the next
+            }
+            else
+            {
+                release(block);
+            }
+            return(true);
+        }
+
+        default:
+            return(false);
+    }
+}
+
+/**
+ @brief Occupy block
+
+ Mark a block as occupied.  Routes including the block are re-evaluated.
+
+ @param block - block number
+ @param owner - id of the loco occupying the block or 0 if not known
+ */
+void Occupancy::occupy(byte block, byte owner)
+{
+    if (block >= OCC_MAX_BLOCKS)
+    {
+        return;
+    }
+    _occupied[BLOCK_WORD(block)] |= BLOCK_BIT(block);
+    _owner[block] = owner;
+    _update(_blockRoutes[block]);
+}
+
+/**
+ @brief Release block
+
+ Mark a block as no longer occupied.  Routes including the block are re-evaluated.
+ A reservation on the block is not affected.
+
+ @param block - block number
+ */
+void Occupancy::release(byte block)
+{
+    if (block >= OCC_MAX_BLOCKS)
+    {
+        return;
+    }
+    _occupied[BLOCK_WORD(block)] &= ~BLOCK_BIT(block);
+    if (!(_reserved[BLOCK_WORD(block)] & BLOCK_BIT(block)))
+    {
+        _owner[block] = 0;
+    }
+    _update(_blockRoutes[block]);
+}
+
+/**
+ @brief Reserve route
+
+ Reserve all the blocks of a route for a loco.  The route must be clear.
+
+ @param route - route index
+ @param owner - id of loco for which the route is reserved
+
+ @return true if the route was reserved.
+ */
+bool Occupancy::reserveRoute(byte route, byte owner)
+{
+    if (route >= _routeCount || !isRouteClear(route))
+    {
+        return(false);
+    }
+    uint32_t affected = 0;
+    for (int i = 0; i < OCC_WORDS; i++)
+    {
+        uint32_t bits = _routeBlocks[route][i];
+        _reserved[i] |= bits;
+        while (bits != 0)
+        {
+            byte b = (i << 5) + __builtin_ctz(bits);
+            bits &= bits - 1;   // clear lowest set bit
+            _owner[b] = owner;
+            affected |= _blockRoutes[b];
+        }
+    }
+    _update(affected);
+    return(true);
+}
+
+/**
+ @brief Release route
+
+ Remove the reservation from all the blocks of a route.
+
+ @param route - route index
+ */
+void Occupancy::releaseRoute(byte route)
+{
+    if (route >= _routeCount)
+    {
+        return;
+    }
+    uint32_t affected = 0;
+    for (int i = 0; i < OCC_WORDS; i++)
+    {
+        uint32_t bits = _routeBlocks[route][i];
+        _reserved[i] &= ~bits;
+        bits &= ~_occupied[i];  // occupied blocks retain their owner
+        while (bits != 0)
+        {
+            byte b = (i << 5) + __builtin_ctz(bits);
+            bits &= bits - 1;
+            _owner[b] = 0;
+            affected |= _blockRoutes[b];
+        }
+    }
+    _update(affected | (((uint32_t)1) << route));
+}
+
+/**
+ @brief Is block occupied
+
+ @param block - block number
+
+ @return true if occupied
+ */
+bool Occupancy::isOccupied(byte block)
+{
+    return(block < OCC_MAX_BLOCKS && (_occupied[BLOCK_WORD(block)] & BLOCK_BIT(block)) != 0);
+}
+
+/**
+ @brief Is block reserved
+
+ @param block - block number
+
+ @return true if reserved
+ */
+bool Occupancy::isReserved(byte block)
+{
+    return(block < OCC_MAX_BLOCKS && (_reserved[BLOCK_WORD(block)] & BLOCK_BIT(block)) != 0);
+}
+
+/**
+ @brief Is route clear
+
+ @param route - route index
+
+ @return true if no block of the route is occupied or reserved
+ */
+bool Occupancy::isRouteClear(byte route)
+{
+    return(route < OCC_MAX_ROUTES && (_routeClear & (((uint32_t)1) << route)) != 0);
+}
+
+/**
+ @brief Get block owner
+
+ @param block - block number
+
+ @return id of the loco occupying or holding a reservation on the block.  0 if none or not known.
+ */
+byte Occupancy::getOwner(byte block)
+{
+    return(block < OCC_MAX_BLOCKS ? _owner[block] : 0);
+}
+
+/**
+ @brief Get loco block
+
+ @param id - reporter id of the loco's tag reader
+
+ @return the block the loco last entered or OCC_NONE if not known
+ */
+byte Occupancy::getLocoBlock(byte id)
+{
+    return(id < OCC_MAX_REPORTERS ? _locoBlock[id] : OCC_NONE);
+}
+
+/*********************************
+ _update
+ *********************************
+
+ Re-evaluate the given routes.  The route handler is called for those
+ whose state has changed.
+
+ parameters  - bitmask of routes to be re-evaluated
+
+ returns none
+ *********************************/
+void Occupancy::_update(uint32_t routes)
+{
+    while (routes != 0)
+    {
+        byte route = __builtin_ctz(routes);
+        routes &= routes - 1;
+        uint32_t bit = ((uint32_t)1) << route;
+        bool clear = _routeFree(route);
+        if (clear != ((_routeClear & bit) != 0))
+        {
+            _routeClear ^= bit;
+            if (_routeHandler != nullptr)
+            {
+                _routeHandler(route, clear);
+            }
+        }
+    }
+}
+
+/*********************************
+ _routeFree
+ *********************************
+
+ Evaluate whether a route is clear from the occupancy and reservation bitsets.
+
+ parameters  - route index
+
+ returns true if no block is occupied or reserved
+ *********************************/
+bool Occupancy::_routeFree(byte route)
+{
+    for (int i = 0; i < OCC_WORDS; i++)
+    {
+        if (_routeBlocks[route][i] & (_occupied[i] | _reserved[i]))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
@@ -0,0 +1,110 @@
+//
+/**
+ @file dawsOccupancy.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsOccupancy__
+#define ____dawsOccupancy__
+
+#define OCC_MAX_BLOCKS 64       ///< maximum number of track blocks - multiple of 32
+#define OCC_MAX_ROUTES 32       ///< maximum number of routes - one bit per route in a 32 bit word
+#define OCC_MAX_TAGS 64         ///< maximum number of track tags that may be bound to blocks
+#define OCC_MAX_REPORTERS 32    ///< maximum reporter id that may be bound to a block or tracked as a loco
+
+#define OCC_WORDS (OCC_MAX_BLOCKS / 32) ///< number of 32 bit words in a block bitset
+#define OCC_NONE 0xFF           ///< no block / no route
+
+/**
+ @brief Route handler type
+
+ A route handler is called when the state of a route changes between clear and not clear.
+ The first parameter is the route index and the second is true if the route is now clear.
+ */
+typedef void (*routeHandler_t)(byte, bool);
+
+/**
+ @brief Block occupancy model
+
+ This maintains the occupancy and reservation state of the track blocks as packed bitsets.
+ It is updated incrementally from reports as they are taken from the report queue so there is no need
+ to rescan the layout.
+
+ - NTAG_NDEF - the loco reading the tag is now in the block to which the tag is bound.  The block
+ previously occupied by that loco is released.  The tag number is taken from the report info.
+ - RA_STATE_CHANGE - a remote accessory bound to a block (e.g. a track circuit) reports occupied if the
+ report info is non zero and clear if zero.  A detector does not know which loco is in the block, so the
+ owner of a block already held by a loco is kept.  Clear does not release a block held by a loco that read
+ a tag in it, as detection may drop out on dirty track; the block is released when the loco reads its next tag.
+
+ Routes are sets of blocks.  Each block holds a bitmask of the routes that include it, so a change to
+ a block re-evaluates only the routes that include that block.  The route handler is only called if a route
+ changes between clear and not clear.  A route is clear if none of its blocks is either occupied or reserved.
+
+ All queries are O(1).
+
+ @note The model is not thread safe.  It is intended to be updated and queried by the single reader of the
+ report queue.
+
+ @note There are no odometer event types as yet, so odometer reports are not used.
+ */
+class Occupancy: mbed::NonCopyable<Occupancy>
+{
+public:
+    Occupancy();
+
+    void bindTag(byte, byte);
+    void bindReporter(byte, byte);
+    byte addRoute(const byte*, byte);
+    void setRouteHandler(routeHandler_t);
+
+    bool processReport(const report_t*);
+
+    void occupy(byte, byte);
+    void release(byte);
+    bool reserveRoute(byte, byte);
+    void releaseRoute(byte);
+
+    bool isOccupied(byte);
+    bool isReserved(byte);
+    bool isRouteClear(byte);
+    byte getOwner(byte);
+    byte getLocoBlock(byte);
+
+private:
+    uint32_t _occupied[OCC_WORDS];          ///< occupied block bitset
+    uint32_t _reserved[OCC_WORDS];          ///< reserved block bitset
+    uint32_t _routeBlocks[OCC_MAX_ROUTES][OCC_WORDS]; ///< blocks making up each route
+    uint32_t _blockRoutes[OCC_MAX_BLOCKS];  ///< routes including each block - one bit per route
+    uint32_t _routeClear;                   ///< clear routes - one bit per route
+    byte _routeCount;                       ///< number of routes defined
+    byte _owner[OCC_MAX_BLOCKS];            ///< id of loco occupying or reserving each block
+    byte _tagBlock[OCC_MAX_TAGS];           ///< block bound to each tag
+    byte _repBlock[OCC_MAX_REPORTERS];      ///< block bound to each (accessory) reporter
+    byte _locoBlock[OCC_MAX_REPORTERS];     ///< block last entered by each loco
+    routeHandler_t _routeHandler;           ///< route state change handler
+
+    void _update(uint32_t);                 ///< re-evaluate the given routes
+    bool _routeFree(byte);                  ///< evaluate route clear from bitsets
+};
+
+#endif /* defined(____dawsOccupancy__) */
@@ -0,0 +1,92 @@
+/**
+@file dawsPathTable.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsPathTable.h"
+
+/**
+ @brief Construct path table
+
+ @param table - pointer to the generated table
+ */
+PathTable::PathTable(const pathTable_t* table)
+{
+    _table = table;
+}
+
+/**
+ @brief Get next hop
+
+ Look up the next hop on the shortest path between two blocks.
+
+ @param from - current block
+ @param to - destination block
+ @param hop - pointer to where the hop is to be returned
+
+ @return true if there is a path.  False if there is no path or the loco is already at the destination.
+ */
+bool PathTable::nextHop(byte from, byte to, pathHop_t* hop)
+{
+    if (from >= _table->blocks || to >= _table->blocks)
+    {
+        return(false);
+    }
+    byte link = _table->nextLink[from * _table->blocks + to];
+    if (link == PATH_NONE)
+    {
+        return(false);
+    }
+    const pathLink_t* lp = &_table->links[link];
+    hop->next = lp->to;
+    hop->reqCount = lp->reqCount;
+    hop->reqs = &_table->reqs[lp->reqFirst];
+    return(true);
+}
+
+/**
+ @brief Is destination reachable
+
+ @param from - current block
+ @param to - destination block
+
+ @return true if there is a path from one block to the other.
+ */
+bool PathTable::isReachable(byte from, byte to)
+{
+    return(from < _table->blocks && to < _table->blocks
+           && _table->nextLink[from * _table->blocks + to] != PATH_NONE);
+}
+
+/**
+ @brief Get block count
+
+ @return the number of blocks in the table
+ */
+byte PathTable::getBlockCount()
+{
+    return(_table->blocks);
+}
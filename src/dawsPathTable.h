@@ -0,0 +1,104 @@
+//
+/**
+ @file dawsPathTable.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsPathTable__
+#define ____dawsPathTable__
+
+#define PATH_NONE 0xFF  ///< no link - destination unreachable
+
+/**
+ @brief Point requirement
+
+ A point and the position it must be set to for a link to be traversed.
+ */
+typedef struct
+{
+    byte point;     ///< point number
+    PointPos_t pos; ///< required position
+} pointReq_t;
+
+/**
+ @brief Path link
+
+ A directed link from one block to an adjacent block.  The point requirements for the link
+ are held as a contiguous run in the table's requirements array.
+ */
+typedef struct
+{
+    byte to;            ///< block at the end of the link
+    byte reqCount;      ///< number of point requirements
+    uint16_t reqFirst;  ///< index of first point requirement
+} pathLink_t;
+
+/**
+ @brief Precomputed path table
+
+ All pairs next hop table as generated from the layout description by the host tool
+ extras/tools/dawsPathGen.cpp.  The generated tables are const so are held in flash.
+
+ nextLink is a blocks x blocks array indexed by [from * blocks + to].  Each entry is the index
+ of the first link on the shortest path from -> to or PATH_NONE if there is no path.
+ */
+typedef struct
+{
+    byte blocks;                ///< number of blocks
+    const byte* nextLink;       ///< next link for each from/to pair
+    const pathLink_t* links;    ///< links
+    const pointReq_t* reqs;     ///< point requirements
+} pathTable_t;
+
+/**
+ @brief Path hop
+
+ The result of a path table look up.
+ */
+typedef struct
+{
+    byte next;              ///< next block on the path
+    byte reqCount;          ///< number of point requirements for the hop
+    const pointReq_t* reqs; ///< point requirements for the hop
+} pathHop_t;
+
+/**
+ @brief Path table look up
+
+ This gives the automaton constant time route selection.  Rather than search the layout graph
+ the next hop towards a destination and the point positions needed for it are read from a table
+ precomputed on the host.
+ */
+class PathTable: mbed::NonCopyable<PathTable>
+{
+public:
+    PathTable(const pathTable_t*);
+
+    bool nextHop(byte, byte, pathHop_t*);
+    bool isReachable(byte, byte);
+    byte getBlockCount();
+
+private:
+    const pathTable_t* _table;  ///< generated table
+};
+
+#endif /* defined(____dawsPathTable__) */
@@ -0,0 +1,330 @@
+/**
+@file dawsPriority.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsPriority.h"
+
+/**
+ @brief Current priorities
+
+ Initialised from the defaults in daws.h.  Indexed by Subsystem_t.
+ */
+osPriority_t Priority::_priorities[SUB_COUNT] = {
+    AUTO_PRIORITY,
+    MOTOR_PRIORITY,
+    ODO_PRIORITY,
+    PN532_PRIORITY,
+    POINT_PRIORITY,
+    BLE_PRIORITY,
+    Vl53_PRIORITY,
+    MAIN_PRIORITY
+};
+
+/**
+ @brief Subsystem names
+
+ Used in configuration strings.  Indexed by Subsystem_t.
+ */
+static const char* const subNames[SUB_COUNT] = {
+    "AUTO", "MOTOR", "ODO", "PN532", "POINT", "BLE", "VL53", "MAIN"
+};
+
+/**
+ @brief Priority names
+
+ Used in configuration strings.
+ */
+static const struct
+{
+    const char* name;
+    osPriority_t priority;
+} priNames[] = {
+    {"Low", osPriorityLow},
+    {"BelowNormal", osPriorityBelowNormal},
+    {"Normal", osPriorityNormal},
+    {"AboveNormal", osPriorityAboveNormal},
+    {"High", osPriorityHigh},
+    {"Realtime", osPriorityRealtime}
+};
+
+/*********************************
+ match
+ *********************************
+
+ Compare a string segment, ignoring case, with a name.
+
+ parameters  - pointer to segment, segment length, name
+
+ returns true if they match
+ *********************************/
+static bool match(const char* s, size_t len, const char* name)
+{
+    if (strlen(name) != len)
+    {
+        return(false);
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (tolower(s[i]) != tolower(name[i]))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+/**
+ @brief Get priority
+
+ @param sub - subsystem
+
+ @return the subsystem's thread priority
+
+ @note This is a static function
+ */
+osPriority_t Priority::get(Subsystem_t sub)
+{
+    return(_priorities[sub]);
+}
+
+/**
+ @brief Set priority
+
+ @param sub - subsystem
+ @param priority - the subsystem's thread priority
+
+ @note This is a static function
+ */
+void Priority::set(Subsystem_t sub, osPriority_t priority)
+{
+    _priorities[sub] = priority;
+}
+
+/**
+ @brief Get subsystem name
+
+ @param sub - subsystem
+
+ @return name as used in configuration strings
+
+ @note This is a static function
+ */
+const char* Priority::getName(Subsystem_t sub)
+{
+    return(subNames[sub]);
+}
+
+/**
+ @brief Configure priorities
+
+ Set priorities from a configuration string.  See class description for format.
+ Entries are applied as they are parsed. Parsing stops at the first bad entry.
+
+ @param config - configuration string
+
+ @return true if the whole string was valid.
+
+ @note This is a static function
+ */
+bool Priority::configure(const char* config)
+{
+    const char* p = config;
+    while (*p != '\0')
+    {
+        const char* end = strchr(p, ',');
+        if (end == nullptr)
+        {
+            end = p + strlen(p);
+        }
+        const char* eq = (const char*)memchr(p, '=', end - p);
+        if (eq == nullptr)
+        {
+            return(false);
+        }
+        int sub = 0;
+        while (sub < SUB_COUNT && !match(p, eq - p, subNames[sub]))
+        {
+            sub++;
+        }
+        if (sub == SUB_COUNT)
+        {
+            return(false);  // unknown subsystem
+        }
+        const char* value = eq + 1;
+        size_t len = end - value;
+        int priority = osPriorityError;
+        for (size_t i = 0; i < sizeof(priNames) / sizeof(priNames[0]); i++)
+        {
+            if (match(value, len, priNames[i].name))
+            {
+                priority = priNames[i].priority;
+            }
+        }
+        if (priority == osPriorityError && len > 0 && isdigit(*value))
+        {
+            char* last;
+            priority = strtol(value, &last, 10);
+            if (last != end || priority <= osPriorityIdle || priority >= osPriorityISR)
+            {
+                priority = osPriorityError;
+            }
+        }
+        if (priority == osPriorityError)
+        {
+            return(false);  // unknown priority
+        }
+        _priorities[sub] = (osPriority_t)priority;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return(true);
+}
+
+/**
+ @brief Construct monitored mutex
+ */
+MonitoredMutex::MonitoredMutex()
+{
+    _owner = nullptr;
+    _ownerPriority = osPriorityNone;
+    resetStats();
+}
+
+/**
+ @brief Lock
+
+ Wait until the mutex is available and lock it.  If INVERSION_TRACE is true and the mutex is held by a thread
+ of lower priority the inversion is recorded.
+ */
+void MonitoredMutex::lock()
+{
+#if INVERSION_TRACE
+    if (!_mutex.trylock())
+    {
+        // the owner may have unlocked since the trylock - then there is nothing to record
+        core_util_critical_section_enter();
+        osThreadId_t owner = _owner;
+        osPriority_t ownerPriority = _ownerPriority;
+        core_util_critical_section_exit();
+        osPriority_t myPriority = osThreadGetPriority(rtos::ThisThread::get_id());
+        unsigned long start = micros();
+        _mutex.lock();
+        if (owner != nullptr && myPriority > ownerPriority)
+        {
+            unsigned long blocked = micros() - start;
+            core_util_critical_section_enter();
+            _stats.count++;
+            _stats.totalBlocked += blocked;
+            if (blocked > _stats.maxBlocked)
+            {
+                _stats.maxBlocked = blocked;
+            }
+            _stats.lastWaiter = osThreadGetName(rtos::ThisThread::get_id());
+            _stats.lastOwner = osThreadGetName(owner);
+            core_util_critical_section_exit();
+        }
+    }
+    _taken();
+#else
+    _mutex.lock();
+#endif
+}
+
+/**
+ @brief Try lock
+
+ Lock the mutex if it is available without waiting.
+
+ @return true if locked
+ */
+bool MonitoredMutex::trylock()
+{
+    if (!_mutex.trylock())
+    {
+        return(false);
+    }
+#if INVERSION_TRACE
+    _taken();
+#endif
+    return(true);
+}
+
+/**
+ @brief Unlock
+ */
+void MonitoredMutex::unlock()
+{
+#if INVERSION_TRACE
+    core_util_critical_section_enter();
+    _owner = nullptr;
+    core_util_critical_section_exit();
+#endif
+    _mutex.unlock();
+}
+
+/**
+ @brief Get statistics
+
+ @param sp - pointer to where the statistics are to be copied.  All zero if INVERSION_TRACE is false.
+ */
+void MonitoredMutex::getStats(inversion_t* sp)
+{
+    core_util_critical_section_enter();
+    *sp = _stats;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Reset statistics
+ */
+void MonitoredMutex::resetStats()
+{
+    core_util_critical_section_enter();
+    memset(&_stats, 0, sizeof(inversion_t));
+    core_util_critical_section_exit();
+}
+
+/*********************************
+ _taken
+ *********************************
+
+ Record the thread now holding the mutex and its priority.  The priority
+ is read before any inheritance can raise it.  Both are set together so
+ a waiter sees a consistent pair.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+void MonitoredMutex::_taken()
+{
+    osThreadId_t owner = rtos::ThisThread::get_id();
+    osPriority_t ownerPriority = osThreadGetPriority(owner);
+    core_util_critical_section_enter();
+    _owner = owner;
+    _ownerPriority = ownerPriority;
+    core_util_critical_section_exit();
+}
@@ -0,0 +1,131 @@
+//
+/**
+ @file dawsPriority.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsPriority__
+#define ____dawsPriority__
+
+#ifndef INVERSION_TRACE
+#define INVERSION_TRACE false   ///< Enable priority inversion recording in MonitoredMutex
+#endif
+
+/**
+ @brief Subsystem
+
+ The subsystems whose thread priority may be configured.
+ */
+enum Subsystem_t : byte
+{
+    SUB_AUTO,   ///< automaton - AUTO_PRIORITY
+    SUB_MOTOR,  ///< motor control - MOTOR_PRIORITY
+    SUB_ODO,    ///< odometer - ODO_PRIORITY
+    SUB_PN532,  ///< NFC controller - PN532_PRIORITY
+    SUB_POINT,  ///< point control - POINT_PRIORITY
+    SUB_BLE,    ///< BLE - BLE_PRIORITY
+    SUB_VL53,   ///< IR TFL sensors - Vl53_PRIORITY
+    SUB_MAIN,   ///< main/UI - MAIN_PRIORITY
+    SUB_COUNT   ///< number of subsystems - must be last
+};
+
+/**
+ @brief Thread priority registry
+
+ This maps subsystems to thread priorities.  The defaults are the *_PRIORITY defines in daws.h.
+ They may be changed at start up from a configuration string, e.g. read from flash or a tag,
+ so priorities may be tuned without a rebuild.
+
+ The configuration string is a comma separated list of subsystem=priority, e.g.
+
+     VL53=High,AUTO=Normal
+
+ Subsystem names are as the Subsystem_t members without the SUB_ prefix.  Priorities are
+ named as the osPriority_t members without the osPriority prefix (Low, BelowNormal, Normal, AboveNormal,
+ High or Realtime) or given as a number.  Names are not case sensitive.
+
+ @note Priorities should be configured before threads are started.  Thread owners fetch their
+ priority with get() when they create or start their thread.
+
+ @note This is a static class.
+ */
+class Priority
+{
+public:
+    static osPriority_t get(Subsystem_t);
+    static void set(Subsystem_t, osPriority_t);
+    static bool configure(const char*);
+    static const char* getName(Subsystem_t);
+
+private:
+    static osPriority_t _priorities[SUB_COUNT];     // current priorities
+};
+
+/**
+ @brief Priority inversion statistics
+
+ An inversion is recorded when a thread blocks on the mutex while it is held by a thread of lower
+ priority.
+ */
+typedef struct
+{
+    uint32_t count;             ///< number of inversions
+    unsigned long maxBlocked;   ///< longest time blocked (us)
+    uint64_t totalBlocked;      ///< total time blocked (us)
+    const char* lastWaiter;     ///< name of higher priority thread last blocked
+    const char* lastOwner;      ///< name of lower priority thread that last held the mutex
+} inversion_t;
+
+/**
+ @brief Monitored Mutex
+
+ An rtos::Mutex for shared resources, e.g. the I2C bus shared by the VL53 sensors and the automaton.
+ If INVERSION_TRACE is true, it records each occasion when a thread is blocked
+ by a thread of lower priority holding the mutex and how long it was blocked.
+
+ The rtos mutex applies priority inheritance so the owner is raised to the waiter's priority.  The
+ block time recorded is the time the waiter actually lost so shows whether inheritance is enough.
+
+ If INVERSION_TRACE is false this is a plain rtos::Mutex.  The layout is the same either way so code built
+ with different settings of INVERSION_TRACE may share it.
+
+ @note Not callable from ISR.
+ */
+class MonitoredMutex: mbed::NonCopyable<MonitoredMutex>
+{
+public:
+    MonitoredMutex();
+    void lock();
+    bool trylock();
+    void unlock();
+    void getStats(inversion_t*);
+    void resetStats();
+
+private:
+    rtos::Mutex _mutex;             ///< the mutex
+    osThreadId_t _owner;            ///< thread holding mutex - only set if INVERSION_TRACE is true
+    osPriority_t _ownerPriority;    ///< its priority when it took the mutex
+    inversion_t _stats;             ///< inversion statistics
+    void _taken();                  ///< record owner
+};
+
+#endif /* defined(____dawsPriority__) */
@@ -0,0 +1,192 @@
+/**
+@file dawsProfile.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsProfile.h"
+
+#if HANDLER_PROFILING
+/**
+ @brief Reporter types profiled
+
+ The position in this list is the index of the reporter type's profile.
+ */
+static const ReporterType reporterTypes[PROFILE_REPORTER_TYPES] = {
+#define REPORTER_TYPE(id, code) id,
+    DAWS_REPORTER_TYPES
+#undef REPORTER_TYPE
+};
+
+handlerProfile_t ReportProfiler::_events[EVENT_TYPE_COUNT];
+handlerProfile_t ReportProfiler::_reporters[PROFILE_REPORTER_TYPES];
+
+/*********************************
+ reporterIndex
+ *********************************
+
+ Find the profile index for a reporter type.
+
+ parameters  - reporter type
+
+ returns index or PROFILE_REPORTER_TYPES if not profiled
+ *********************************/
+static int reporterIndex(ReporterType type)
+{
+    int i = 0;
+    while (i < PROFILE_REPORTER_TYPES && reporterTypes[i] != type)
+    {
+        i++;
+    }
+    return(i);
+}
+#endif
+
+/**
+ @brief Get event type profile
+
+ @param type - event type
+ @param pp - pointer to where the profile is to be copied
+
+ @return true if profiling is enabled
+
+ @note This is a static function
+ */
+bool ReportProfiler::getEventProfile(EventType type, handlerProfile_t* pp)
+{
+#if HANDLER_PROFILING
+    if (type >= EVENT_TYPE_COUNT)
+    {
+        return(false);
+    }
+    core_util_critical_section_enter();
+    *pp = _events[type];
+    core_util_critical_section_exit();
+    return(true);
+#else
+    (void)type;
+    (void)pp;
+    return(false);
+#endif
+}
+
+/**
+ @brief Get reporter type profile
+
+ @param type - reporter type
+ @param pp - pointer to where the profile is to be copied
+
+ @return true if profiling is enabled and the reporter type is profiled
+
+ @note This is a static function
+ */
+bool ReportProfiler::getReporterProfile(ReporterType type, handlerProfile_t* pp)
+{
+#if HANDLER_PROFILING
+    int i = reporterIndex(type);
+    if (i >= PROFILE_REPORTER_TYPES)
+    {
+        return(false);
+    }
+    core_util_critical_section_enter();
+    *pp = _reporters[i];
+    core_util_critical_section_exit();
+    return(true);
+#else
+    (void)type;
+    (void)pp;
+    return(false);
+#endif
+}
+
+/**
+ @brief Reset profiles
+
+ @note This is a static function
+ */
+void ReportProfiler::reset()
+{
+#if HANDLER_PROFILING
+    core_util_critical_section_enter();
+    memset(_events, 0, sizeof(_events));
+    memset(_reporters, 0, sizeof(_reporters));
+    core_util_critical_section_exit();
+#endif
+}
+
+#if HANDLER_PROFILING
+/*********************************
+ add
+ *********************************
+
+ Add a handler time to a profile.
+
+ parameters  - pointer to profile, handler time (us)
+
+ returns none
+ *********************************/
+static void add(handlerProfile_t* pp, unsigned long time)
+{
+    int bin = (time == 0) ? 0 : 32 - __builtin_clz(time);
+    if (bin >= PROFILE_HIST_BINS)
+    {
+        bin = PROFILE_HIST_BINS - 1;
+    }
+    pp->count++;
+    pp->total += time;
+    pp->hist[bin]++;
+    if (time > pp->max)
+    {
+        pp->max = time;
+    }
+}
+
+/*********************************
+ _record
+ *********************************
+
+ Add a handler time to the profiles for the report's event type and
+ reporter type.
+
+ parameters  - pointer to report, handler time (us)
+
+ returns none
+ *********************************/
+void ReportProfiler::_record(const report_t* rdp, unsigned long time)
+{
+    int r = reporterIndex(rdp->source->getType());
+    core_util_critical_section_enter();
+    if (rdp->repType < EVENT_TYPE_COUNT)
+    {
+        add(&_events[rdp->repType], time);
+    }
+    if (r < PROFILE_REPORTER_TYPES)
+    {
+        add(&_reporters[r], time);
+    }
+    core_util_critical_section_exit();
+}
+#endif
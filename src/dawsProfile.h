@@ -0,0 +1,107 @@
+//
+/**
+ @file dawsProfile.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsProfile__
+#define ____dawsProfile__
+
+#ifndef HANDLER_PROFILING
+#define HANDLER_PROFILING false ///< Enable report handler profiling
+#endif
+
+#define PROFILE_HIST_BINS 16    ///< number of handler time histogram bins
+#define PROFILE_REPORTER_TYPES REPORTER_TYPE_COUNT   ///< number of reporter types profiled - all of them
+
+/**
+ @brief Report handler type
+
+ The application's handler for a report taken from the report queue.
+ */
+typedef void (*reportHandler_t)(report_t*);
+
+/**
+ @brief Handler profile
+
+ The histogram holds handler times in power of two bins.  Bin 0 is under 1us, bin n is from 2^(n-1) to
+ 2^n - 1 us and the last bin holds everything larger.
+ */
+typedef struct
+{
+    uint32_t count;                     ///< number of reports handled
+    unsigned long max;                  ///< longest handler time (us)
+    uint64_t total;                     ///< total handler time (us) - for average
+    uint32_t hist[PROFILE_HIST_BINS];   ///< handler time histogram
+} handlerProfile_t;
+
+/**
+ @brief Report handler profiler
+
+ The report reader passes each report to its handler through dispatch().  The handler is called
+ and the report marked as handled.  If HANDLER_PROFILING is true the handler time is also
+ accumulated by event type and by reporter type so slow handlers, which back up the report queue, may be found.
+
+ If HANDLER_PROFILING is false dispatch() is inline and only calls the handler and marks the report
+ handled.  There is no profiling data.
+
+ @note Profiles are updated only by the report reader.
+
+ @note This is a static class.
+ */
+class ReportProfiler
+{
+public:
+    /**
+     @brief Dispatch report
+
+     Call the handler for a report and then mark the report handled.
+
+     @param rdp - pointer to report as returned by tryGetReport
+     @param handler - the report handler
+     */
+    static inline void dispatch(report_t* rdp, reportHandler_t handler)
+    {
+#if HANDLER_PROFILING
+        unsigned long start = micros();
+        handler(rdp);
+        Reporter::markHandled(rdp);
+        _record(rdp, rdp->timeStampDone - start);
+#else
+        handler(rdp);
+        Reporter::markHandled(rdp);
+#endif
+    }
+
+    static bool getEventProfile(EventType, handlerProfile_t*);
+    static bool getReporterProfile(ReporterType, handlerProfile_t*);
+    static void reset();
+
+private:
+#if HANDLER_PROFILING
+    static handlerProfile_t _events[EVENT_TYPE_COUNT];          // by event type
+    static handlerProfile_t _reporters[PROFILE_REPORTER_TYPES]; // by reporter type
+    static void _record(const report_t*, unsigned long);        // add to profiles
+#endif
+};
+
+#endif /* defined(____dawsProfile__) */
@@ -28,7 +28,10 @@
 #include <Arduino.h>
 #include <mbed.h>
 #include <daws.h>
+#include <new>
 #include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsTrace.h"
 
 #define DEBUG false  ///< Enable Reporter debug if needed
 
@@ -38,9 +41,23 @@
 
 
 
-Reporter* Reporter::_lastInstantiated;   // pointer to last created reporter
-Reporter* Reporter::_firstReporter;      // pointer to first reporter in chain
-byte Reporter::_lastId;                  // last ID allocated
+DAWS_CONSTINIT Reporter* Reporter::_lastInstantiated = nullptr;   // pointer to last created reporter
+DAWS_CONSTINIT Reporter* Reporter::_firstReporter = nullptr;      // pointer to first reporter in chain
+DAWS_CONSTINIT Reporter* Reporter::_unmasked = nullptr;           // first reporter whose mask is unread
+DAWS_CONSTINIT byte Reporter::_lastId = 0;                        // last ID allocated
+
+#define QUEUE_NONE 0        ///< report queue not made
+#define QUEUE_MAKING 1      ///< report queue being made
+#define QUEUE_READY 2       ///< report queue made
+
+/**
+ @brief Report queue storage
+
+ The rtos::Mail is constructed here by _makeQueue() rather than as a static object, as its
+ constructor would run before main in an order not guaranteed relative to reporters
+ constructed in other translation units.
+ */
+MBED_ALIGN(8) static unsigned char queueStorage[sizeof(rtos::Mail<report_t, REPORT_QUEUE_LEN>)];
 
 /**
  @brief Queue for reported events.
@@ -50,9 +67,93 @@ byte Reporter::_lastId;                  // last ID allocated
  
  @note the rtos queue holds a list of pointers.  Here the pointers refer to reports.
  */
-rtos::Mail<report_t, 16> Reporter::_reportQueue;
+DAWS_CONSTINIT rtos::Mail<report_t, REPORT_QUEUE_LEN>* Reporter::_reportQueue = nullptr;
+DAWS_CONSTINIT volatile uint8_t Reporter::_queueState = QUEUE_NONE;
+
+DAWS_CONSTINIT volatile uint16_t Reporter::_queueFullCount = 0;    ///< count of reports dropped
+DAWS_CONSTINIT volatile uint32_t Reporter::_shedCount[REPORT_CLASS_COUNT] = {};    ///< reports dropped by class
+DAWS_CONSTINIT volatile bool Reporter::_shedding[REPORT_CLASS_COUNT] = {};  ///< class shed since last admitted
 
-volatile uint16_t Reporter::_queueFullCount = 0;    ///< count of report queue full incidents
+/**
+ @brief Event type classes
+
+ The importance class of each event type, in EventType order.  May be changed by setEventClass().
+ */
+DAWS_CONSTINIT ReportClass Reporter::_eventClass[EVENT_TYPE_COUNT] =
+{
+    CLASS_NORMAL,       // REPORT_OVERRUN
+    CLASS_CRITICAL,     // LOCO_STOP
+    CLASS_CRITICAL,     // VL53_RANGE_CLOSE
+    CLASS_LOW,          // VL53_RANGE_NORMAL
+    CLASS_LOW,          // VL53_OUT_OF_RANGE
+    CLASS_CRITICAL,     // VL53_ERR
+    CLASS_NORMAL,       // NTAG_NDEF
+    CLASS_NORMAL,       // NTAG_NONDEF
+    CLASS_NORMAL,       // MIFARE_C1K_FOUND
+    CLASS_NORMAL,       // MIFARE_DEP_FOUND
+    CLASS_NORMAL,       // MIFARE_DEP_MSG
+    CLASS_NORMAL,       // MIFARE_DEP_PASSIVE
+    CLASS_NORMAL,       // NFC_OTHER_FOUND
+    CLASS_NORMAL,       // NFC_TAG_TYPE_UNKNOWN
+    CLASS_LOW,          // RA_DISCOVERED
+    CLASS_NORMAL,       // RA_STATE_CHANGE
+    CLASS_NORMAL,       // RA_CONNECTED
+    CLASS_NORMAL,       // RA_DISCONNECTED
+    CLASS_LOW,          // BLE_SCAN_START
+    CLASS_LOW,          // BLE_SCAN_DONE
+    CLASS_LOW,          // BLE_PEER_FOUND
+    CLASS_NORMAL,       // BLE_CONNECTED
+    CLASS_NORMAL,       // BLE_SERVICES_AVAIL
+    CLASS_NORMAL,       // BLE_CONNECT_FAIL
+    CLASS_NORMAL,       // BLE_DISCONNECTED
+    CLASS_NORMAL,       // ACC_STATE_CHANGE
+    CLASS_NORMAL,       // ROTQ_ROT
+    CLASS_NORMAL,       // ROTQ_ERR
+    CLASS_NORMAL,       // SET_AUTO
+    CLASS_NORMAL        // LOOP_OVERRUN
+};
+
+/**
+ @brief Class limits
+
+ The queue depth at which reports of each class are shed.
+ */
+static const byte classLimit[REPORT_CLASS_COUNT] = {REPORT_LIMIT_LOW, REPORT_LIMIT_NORMAL, REPORT_QUEUE_LEN};
+
+/**
+ @brief Report queue depth
+
+ Counted up when a report is admitted, before it is allocated, and down when one has been retrieved
+ so it never goes below 0 and never exceeds the slots in use.  The peak is the highest depth since takeQueuePeak() was last called.
+ */
+DAWS_CONSTINIT volatile uint8_t Reporter::_queueDepth = 0;
+DAWS_CONSTINIT volatile uint8_t Reporter::_queuePeak = 0;
+
+/**
+ @brief Publication epoch
+
+ Incremented before and after each latest value is published so it is odd while a publish is in progress.
+ A snapshot is consistent if the epoch is the same, and even, before and after it is taken.
+ */
+DAWS_CONSTINIT volatile uint32_t Reporter::_publishEpoch = 0;
+
+#define SNAPSHOT_RETRIES 4  ///< number of attempts to take a consistent snapshot
+
+/**
+ @brief Latency statistics
+
+ Indexed by event type.  Updated by markHandled.
+ */
+DAWS_CONSTINIT latencyStats_t Reporter::_latencyStats[EVENT_TYPE_COUNT] = {};
+
+static_assert(EVENT_TYPE_COUNT <= 32, "event types do not fit an event mask");
+
+/**
+ @brief Subscriber counts
+
+ Indexed by event type.  Updated by subscribe and unsubscribe.
+ */
+DAWS_CONSTINIT byte Reporter::_subscribers[EVENT_TYPE_COUNT] = {};
 
 
 
@@ -71,19 +172,16 @@ volatile uint16_t Reporter::_queueFullCount = 0;    ///< count of report queue f
 Reporter::Reporter(ReporterType type)
 {
     //_type = type;  // type now held by inheriting class
+    _rateLevel = 0;
+    _muted = false;
+    _demand = 0;
+    _active = false;
+    _setupDone = false;
+    core_util_critical_section_enter();
     _id = ++_lastId;  // assign id automatically
-    if (_firstReporter == nullptr) // I'm the first
-    {
-     
-        _firstReporter = this;  // set static class variable
-    
-    }
-    else
-    {
-        _lastInstantiated->_link(this); // link the former last reporter to this one
-    }
-    _lastInstantiated = this;   // update static class variable so this is now the last
-    _nextReporter = nullptr;       // and ensure that the next reporter in chain is null
+    _register();
+    core_util_critical_section_exit();
+    _makeQueue();
 }
 
 /**
@@ -103,18 +201,15 @@ Reporter::Reporter(ReporterType type, byte id) // as above but id specified.
 {
     _id = id;
     //_type = type;
-    if (_firstReporter == nullptr) // I'm the first
-    {
-        
-        _firstReporter = this;
-        
-    }
-    else
-    {
-        _lastInstantiated->_link(this); // link the previous one to this one
-    }
-    _lastInstantiated = this;   // make this one the last one
-    _nextReporter = nullptr;
+    _rateLevel = 0;
+    _muted = false;
+    _demand = 0;
+    _active = false;
+    _setupDone = false;
+    core_util_critical_section_enter();
+    _register();
+    core_util_critical_section_exit();
+    _makeQueue();
 }
 
 /**
@@ -148,6 +243,232 @@ void Reporter::setup()
     // default version of virtual function
 }
 
+/**
+ @brief Get Event Mask
+
+ Default version of the event mask function for derived classes that are set up
+ by the application rather than activated lazily.
+
+ An override returns the event types the reporter may report, each as EVENT_BIT(type).
+
+ @note This is declared as being virtual.
+
+ @return 0 - not activated lazily
+ */
+uint32_t Reporter::getEventMask()
+{
+    return(0);
+}
+
+/**
+ @brief Active changed
+
+ Called when a lazily activated reporter is put to sleep and when it is woken again.  It is not
+ called on the first activation, which calls setup() instead.  The default version does nothing.
+
+ @param active - true if woken, false if put to sleep
+
+ @note This is declared as being virtual.  It is called in the thread subscribing or activating.
+ */
+void Reporter::activeChanged(bool active)
+{
+    // default version of virtual function
+    (void)active;
+}
+
+/**
+ @brief Activate
+
+ Explicitly request the reporter to be active, e.g. for a device needed in every mode.  Activations are
+ counted with subscriptions; each must be matched by release().
+
+ @note Not thread safe.  Activation and subscription should be done from one thread, e.g. the control
+ thread changing mode.
+ */
+void Reporter::activate()
+{
+    _activateLate();
+    _demandChanged(true);
+}
+
+/**
+ @brief Release
+
+ Withdraw an explicit activation.  The reporter sleeps if no subscriptions or activations remain.
+
+ @note Not thread safe, as activate().
+ */
+void Reporter::release()
+{
+    _activateLate();
+    _demandChanged(false);
+}
+
+/**
+ @brief Is Active
+
+ @return true if activated and not asleep
+ */
+bool Reporter::isActive()
+{
+    return(_active);
+}
+
+/**
+ @brief Subscribe
+
+ A static routine to subscribe to an event type.  The first subscription to an
+ event type activates every reporter whose event mask includes it.  The count sticks
+ at 255 once reached, so it never falls to 0 while a subscription remains.
+
+ @param repType - event type
+
+ @note Not thread safe, as activate().
+ */
+void Reporter::subscribe(EventType repType)
+{
+    _activateLate();
+    if (repType >= EVENT_TYPE_COUNT || _subscribers[repType] == 0xff)
+    {
+        return;
+    }
+    if (_subscribers[repType]++ == 0)
+    {
+        for (Reporter* rp = _firstReporter; rp != nullptr; rp = rp->_nextReporter)
+        {
+            if ((rp->getEventMask() & EVENT_BIT(repType)) != 0)
+            {
+                rp->_demandChanged(true);
+            }
+        }
+    }
+}
+
+/**
+ @brief Unsubscribe
+
+ A static routine to withdraw a subscription.  When the last subscription to an event type
+ is withdrawn the reporters whose event mask includes it lose that demand and may sleep.
+ Nothing is withdrawn once the count has stuck at 255.
+
+ @param repType - event type
+
+ @note Not thread safe, as activate().
+ */
+void Reporter::unsubscribe(EventType repType)
+{
+    _activateLate();
+    if (repType >= EVENT_TYPE_COUNT || _subscribers[repType] == 0 || _subscribers[repType] == 0xff)
+    {
+        return;
+    }
+    if (--_subscribers[repType] == 0)
+    {
+        for (Reporter* rp = _firstReporter; rp != nullptr; rp = rp->_nextReporter)
+        {
+            if ((rp->getEventMask() & EVENT_BIT(repType)) != 0)
+            {
+                rp->_demandChanged(false);
+            }
+        }
+    }
+}
+
+/**
+ @brief Get Subscribers
+
+ @param repType - event type
+
+ @return number of subscriptions to the event type
+ */
+byte Reporter::getSubscribers(EventType repType)
+{
+    return((repType < EVENT_TYPE_COUNT) ? _subscribers[repType] : 0);
+}
+
+/*********************************
+ _demandChanged
+ *********************************
+
+ Count demand for this reporter up or down.  On the first demand
+ setup() is called, on later demand from none the reporter is woken
+ and when demand falls to none it is put to sleep.  The count sticks
+ at 255 once reached, as the subscription counts.
+
+ parameters  - true to count up, false to count down
+
+ returns none
+ *********************************/
+void Reporter::_demandChanged(bool up)
+{
+    if (up)
+    {
+        if (_demand == 0xff)
+        {
+            return;
+        }
+        if (_demand++ == 0)
+        {
+            _active = true;
+            if (!_setupDone)
+            {
+                _setupDone = true;
+                setup();
+            }
+            else
+            {
+                activeChanged(true);
+            }
+        }
+    }
+    else if (_demand != 0 && _demand != 0xff)
+    {
+        if (--_demand == 0)
+        {
+            _active = false;
+            activeChanged(false);
+        }
+    }
+}
+
+/*********************************
+ _activateLate
+ *********************************
+
+ Count the subscriptions to their event types for reporters
+ constructed since this was last called, as subscribe() did not
+ find them.  A reporter's event mask, a virtual function, cannot
+ be read by the constructor.  The reporters to check are taken in
+ a critical section as reporters may be constructed in any thread.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+void Reporter::_activateLate()
+{
+    if (_unmasked == nullptr)
+    {
+        return;
+    }
+    core_util_critical_section_enter();
+    Reporter* first = _unmasked;
+    Reporter* last = _lastInstantiated;
+    _unmasked = nullptr;
+    core_util_critical_section_exit();
+    for (Reporter* rp = first; rp != nullptr; rp = (rp == last) ? nullptr : rp->_nextReporter)
+    {
+        uint32_t mask = rp->getEventMask();
+        for (int e = 0; mask != 0 && e < EVENT_TYPE_COUNT; e++)
+        {
+            if ((mask & EVENT_BIT(e)) != 0 && _subscribers[e] != 0)
+            {
+                rp->_demandChanged(true);
+            }
+        }
+    }
+}
+
 /*********************************
  _link
  *********************************
@@ -167,6 +488,67 @@ void Reporter::_link(Reporter* newReporter)
     _nextReporter = newReporter;     // set up next in chain
 }
 
+/*********************************
+ _register
+ *********************************
+ 
+ Add this reporter to the end of the chain.  The next pointer
+ is cleared before the reporter is linked so a reporter walking
+ the chain never sees it unset.  Called by the constructors
+ in a critical section so reporters constructed concurrently
+ are each linked once.
+ 
+ parameters  - none
+ 
+ returns none
+ *********************************/
+void Reporter::_register()
+{
+    _nextReporter = nullptr;       // ensure that the next reporter in chain is null
+    if (_firstReporter == nullptr) // I'm the first
+    {
+        _firstReporter = this;  // set static class variable
+    }
+    else
+    {
+        _lastInstantiated->_link(this); // link the former last reporter to this one
+    }
+    _lastInstantiated = this;   // update static class variable so this is now the last
+    if (_unmasked == nullptr)
+    {
+        _unmasked = this;       // event mask read by _activateLate()
+    }
+}
+
+/*********************************
+ _makeQueue
+ *********************************
+ 
+ Construct the report queue in its static storage if not
+ already made.  The first caller to claim it constructs it; any
+ other caller meanwhile sleeps until it is ready, so a lower
+ priority constructor is not starved by a waiter spinning.  Not called
+ from ISR.  Reports are only queued by constructed reporters
+ so the queue is always made before it is used by _queue.
+ 
+ parameters  - none
+ 
+ returns none
+ *********************************/
+void Reporter::_makeQueue()
+{
+    uint8_t state = QUEUE_NONE;
+    if (core_util_atomic_cas_u8(&_queueState, &state, QUEUE_MAKING))
+    {
+        _reportQueue = new (queueStorage) rtos::Mail<report_t, REPORT_QUEUE_LEN>();
+        core_util_atomic_store_u8(&_queueState, QUEUE_READY);
+    }
+    while (core_util_atomic_load_u8(&_queueState) != QUEUE_READY)
+    {
+        rtos::ThisThread::sleep_for(rtos::Kernel::Clock::duration_u32(1));
+    }
+}
+
 /**
  @brief Get First Reporter
  
@@ -206,6 +588,8 @@ byte Reporter::getId()
  This adds a report to the  report queue.  An overrun report  is generated if
  a prevous report from this object has not been processed.
  
+ The event time is taken to be the time the report is added to the queue.
+ 
  @param repType - type of report to be added
  
  @param info - generic information, usage depends on originating source
@@ -215,8 +599,73 @@ byte Reporter::getId()
  */
 void Reporter::queueReport(EventType repType, int info)
 {
-    
-    report_t* rp = _reportQueue.try_alloc();
+    _queue(repType, info, 0, false);
+}
+
+/**
+ Add a report to the queue with event time.
+ 
+ As above but the originator gives the time of the event, e.g. as captured in the ISR
+ when the hardware event occurred.  The time from event to report is then included in the latency statistics.
+ 
+ @param repType - type of report to be added
+ 
+ @param info - generic information, usage depends on originating source
+ 
+ @param eventTime - time of the event as given by micros()
+ 
+ @note this is callable from ISR and therefore should not include DEBUG prints.
+ 
+ */
+void Reporter::queueReport(EventType repType, int info, unsigned long eventTime)
+{
+    _queue(repType, info, eventTime, true);
+}
+
+/*********************************
+ _queue
+ *********************************
+ 
+ Add a report to the queue.  Nothing is done if the reporter is muted.  A slot is
+ reserved by compare and exchange of the queue depth if the depth is below the
+ limit for the report's class, so concurrent reporters cannot together take the
+ reserved slots.  Otherwise the report is shed and counted.  The time is only
+ read if the report is admitted.
+ 
+ parameters  - report type, info, event time, true if event time given
+ 
+ returns none
+ *********************************/
+void Reporter::_queue(EventType repType, int info, unsigned long eventTime, bool hasEventTime)
+{
+    if (core_util_atomic_load_bool(&_muted))
+    {
+        return;     // nobody wants it
+    }
+    ReportClass repClass = (repType < EVENT_TYPE_COUNT) ? _eventClass[repType] : CLASS_NORMAL;
+    uint8_t limit = classLimit[repClass];
+    uint8_t depth = core_util_atomic_load_u8(&_queueDepth);
+    report_t* rp = nullptr;
+    bool admitted;
+    do
+    {
+        admitted = (depth < limit);
+    } while (admitted && !core_util_atomic_cas_u8(&_queueDepth, &depth, depth + 1));  // depth reloaded if exchange fails
+
+    if (admitted)
+    {
+        depth++;
+        uint8_t peak = core_util_atomic_load_u8(&_queuePeak);
+        while (depth > peak && !core_util_atomic_cas_u8(&_queuePeak, &peak, depth))
+        {
+            // peak reloaded by failed exchange
+        }
+        rp = _reportQueue->try_alloc();  // only fails if depth is wrong
+        if (rp == nullptr)
+        {
+            core_util_atomic_decr_u8(&_queueDepth, 1);
+        }
+    }
     if (rp != nullptr)
     {
         // alloc worked
@@ -224,14 +673,272 @@ void Reporter::queueReport(EventType repType, int info)
         rp->info = info;
         rp->source = this;
         rp->timeStampIn = micros();
-        _reportQueue.put(rp);  // use of error return deprecated - will always succeed if alloc worked.
+        rp->timeStampEvent = hasEventTime ? eventTime : rp->timeStampIn;
+        _reportQueue->put(rp);  // use of error return deprecated - will always succeed if alloc worked.
+        if (core_util_atomic_load_bool(&_shedding[repClass]))
+        {
+            core_util_atomic_store_bool(&_shedding[repClass], false);   // shed episode over
+        }
     }
     else
     {
-        // queue full
-        _queueFullCount++;
+        // shed or queue full - logged on the first drop of the class since one was last admitted
+        core_util_atomic_incr_u16(&_queueFullCount, 1);
+        core_util_atomic_incr_u32(&_shedCount[repClass], 1);
+        core_util_atomic_store_u8(&_queuePeak, REPORT_QUEUE_LEN);     // shedding counts as full
+        if (!core_util_atomic_exchange_bool(&_shedding[repClass], true))
+        {
+            if (repClass == CLASS_CRITICAL)
+            {
+                Log::write(LOG_QUEUE_FULL, getType(), _id, repType);
+            }
+            else
+            {
+                Log::write(LOG_SHED, repClass, getType(), _id, repType);
+            }
+        }
+        Trace::drop(repType, this);
+    }
+}
+
+/**
+ Get queue full count.
+
+ @return number of reports dropped because the report queue was full or above the limit for their class,
+ from all reporters.  Wraps at 16 bits.
+ */
+uint16_t Reporter::getQueueFullCount()
+{
+    return(core_util_atomic_load_u16(&_queueFullCount));
+}
+
+/**
+ Get shed count.
+
+ @param repClass - importance class
+
+ @return number of reports of the class dropped, from all reporters.
+ */
+uint32_t Reporter::getShedCount(ReportClass repClass)
+{
+    if (repClass >= REPORT_CLASS_COUNT)
+    {
+        return(0);
+    }
+    return(core_util_atomic_load_u32(&_shedCount[repClass]));
+}
+
+/**
+ Get event class.
+
+ @param repType - event type
+
+ @return importance class of the event type.
+ */
+ReportClass Reporter::getEventClass(EventType repType)
+{
+    return((repType < EVENT_TYPE_COUNT) ? _eventClass[repType] : CLASS_NORMAL);
+}
+
+/**
+ Set event class.
+
+ Change the importance class of an event type from its default, e.g. to make BLE_DISCONNECTED critical
+ for a remote that must stop when it loses its controller.
+
+ @param repType - event type
+ @param repClass - importance class
+
+ @note Should be set before reporters are started.
+ */
+void Reporter::setEventClass(EventType repType, ReportClass repClass)
+{
+    if (repType < EVENT_TYPE_COUNT && repClass < REPORT_CLASS_COUNT)
+    {
+        _eventClass[repType] = repClass;
+    }
+}
+
+/**
+ Get queue depth.
+
+ @return number of reports in the report queue, including any being added.
+ */
+byte Reporter::getQueueDepth()
+{
+    return(core_util_atomic_load_u8(&_queueDepth));
+}
+
+/**
+ Take queue peak.
+
+ Returns the highest queue depth since the last call and starts a new peak from the depth now, so
+ bursts between calls are not missed.  If any report has been dropped the peak is REPORT_QUEUE_LEN.
+
+ @return peak report queue depth.
+ */
+byte Reporter::takeQueuePeak()
+{
+    return(core_util_atomic_exchange_u8(&_queuePeak, core_util_atomic_load_u8(&_queueDepth)));
+}
+
+/**
+ Set rate level.
+
+ Requests the reporter to reduce its sampling rate.  Level 0 is full rate and each level above should
+ about halve it.  The default version records the level for getRateLevel().
+
+ @param level - rate level
+
+ @note This is declared as being virtual.  An override should call this version so getRateLevel() is correct.
+ */
+void Reporter::setRateLevel(byte level)
+{
+    _rateLevel = level;
+}
+
+/**
+ Mute reporter.
+
+ Reports from this reporter are discarded before they are queued until resume() is called.
+ Latest values are still published.  If the reporter was not muted muteChanged() is called.
+
+ @note Not callable from ISR as muteChanged() may not be.
+ */
+void Reporter::mute()
+{
+    if (!core_util_atomic_exchange_bool(&_muted, true))
+    {
+        muteChanged(true);
+    }
+}
+
+/**
+ Resume reporter.
+
+ Reports from this reporter are queued again.  If the reporter was muted muteChanged() is called.
+
+ @note Not callable from ISR as muteChanged() may not be.
+ */
+void Reporter::resume()
+{
+    if (core_util_atomic_exchange_bool(&_muted, false))
+    {
+        muteChanged(false);
+    }
+}
+
+/**
+ Is reporter muted.
+
+ @return true if muted.
+ */
+bool Reporter::isMuted()
+{
+    return(core_util_atomic_load_bool(&_muted));
+}
+
+/**
+ Mute changed.
+
+ Called by mute() and resume() when the reporter is muted or resumed, so a device may stop and
+ restart sampling.  The default version does nothing.
+
+ @param muted - true if now muted
+
+ @note This is declared as being virtual.  It is called in the thread calling mute() or resume().
+ */
+void Reporter::muteChanged(bool muted)
+{
+    // default version of virtual function
+    (void)muted;
+}
+
+/**
+ Get rate level.
+
+ @return rate level as last set - 0 for full rate.
+ */
+byte Reporter::getRateLevel()
+{
+    return(_rateLevel);
+}
+
+/**
+ Publish latest value.
+
+ This updates the reporter's latest value cell.  It does not use the report queue.
+ Readers polling for the latest value see it at once.
+
+ @param value - the value, usage depends on originating source
+
+ @note this is callable from ISR and therefore should not include DEBUG prints.
+
+ */
+void Reporter::publishLatest(int value)
+{
+    latest_t latest;
+    latest.value = value;
+    latest.timeStamp = micros();
+    core_util_critical_section_enter();  // nests with the sequence lock's
+    core_util_atomic_store_u32(&_publishEpoch, _publishEpoch + 1);
+    _latest.write(latest);
+    core_util_atomic_store_u32(&_publishEpoch, _publishEpoch + 1);
+    core_util_critical_section_exit();
+}
+
+/**
+ Get latest value.
+
+ This reads the reporter's latest value cell without locking.  It is callable from any
+ thread or ISR.
+
+ @param lp - pointer to where the latest value is to be copied.
+
+ @return true if a value has been published.
+ */
+bool Reporter::getLatest(latest_t* lp)
+{
+    return(_latest.read(lp) != 0);
+}
+
+/**
+ Take snapshot of all reporters.
+
+ This walks the reporter chain and captures each reporter's latest value.  If any value is
+ published while the snapshot is being taken it is retried, up to a limit, so
+ that all values are as at one instant.  Producers are not stopped or delayed.
+
+ @param states - pointer to array where the reporter states are to be copied.
+ @param max - size of array.  Reporters beyond this are not captured.
+ @param count - pointer to where the number of reporter states captured is to be returned.
+
+ @return true if the snapshot is consistent.  If false the values are each valid but may not all
+ be from the same instant.
+ */
+bool Reporter::snapshot(repState_t* states, byte max, byte* count)
+{
+    for (int attempt = 0; attempt < SNAPSHOT_RETRIES; attempt++)
+    {
+        uint32_t epoch = core_util_atomic_load_u32(&_publishEpoch);
+        byte n = 0;
+        for (Reporter* rp = _firstReporter; rp != nullptr && n < max; rp = rp->_nextReporter)
+        {
+            repState_t* sp = &states[n++];
+            sp->source = rp;
+            sp->id = rp->_id;
+            sp->type = rp->getType();
+            sp->valid = (rp->_latest.read(&sp->latest) != 0);
+        }
+        *count = n;
+        if ((epoch & 1) == 0 && core_util_atomic_load_u32(&_publishEpoch) == epoch)
+        {
+            return(true);
+        }
     }
+    return(false);
 }
+
 /**
  Get a report from queue without waiting.
  
@@ -263,7 +970,11 @@ bool Reporter::tryGetReport(report_t* rdp)
 
 bool Reporter::tryGetReport(report_t* rdp, rtos::Kernel::Clock::duration_u32 waitTime)
 {
-    report_t* rsp = _reportQueue.try_get_for(waitTime);  // see if any thing there
+    if (core_util_atomic_load_u8(&_queueState) != QUEUE_READY)
+    {
+        _makeQueue();   // no reporter constructed yet
+    }
+    report_t* rsp = _reportQueue->try_get_for(waitTime);  // see if any thing there
     if (rsp != nullptr) // is there any thing there?
     {
         // there's something there
@@ -271,9 +982,12 @@ bool Reporter::tryGetReport(report_t* rdp, rtos::Kernel::Clock::duration_u32 wai
         rdp->repType = rsp->repType;
         rdp->source = rsp->source;
         rdp->info = rsp->info;
+        rdp->timeStampEvent = rsp->timeStampEvent;
         rdp->timeStampIn = rsp->timeStampIn;  // including time stamp
         rdp->timeStampOut = micros();         // set time now for recipient
-        _reportQueue.free(rsp);  // error not checked
+        rdp->timeStampDone = 0;               // until marked handled
+        _reportQueue->free(rsp);  // error not checked
+        core_util_atomic_decr_u8(&_queueDepth, 1);
         return(true);
     }
     else
@@ -281,3 +995,67 @@ bool Reporter::tryGetReport(report_t* rdp, rtos::Kernel::Clock::duration_u32 wai
         return(false);
     }
 }
+
+/**
+ Mark report handled.
+ 
+ Called by the recipient when it has finished handling a report.  The completion time is set
+ in the report and the report's event to queue, queue wait and handler times are added to
+ the latency statistics for its event type.  If the trace recorder is on the report is recorded.
+ 
+ @param rdp - pointer to the report as returned by tryGetReport.
+ */
+void Reporter::markHandled(report_t* rdp)
+{
+    rdp->timeStampDone = micros();
+    Trace::report(rdp);
+    if (rdp->repType >= EVENT_TYPE_COUNT)
+    {
+        return;
+    }
+    unsigned long report = rdp->timeStampIn - rdp->timeStampEvent;
+    unsigned long wait = rdp->timeStampOut - rdp->timeStampIn;
+    unsigned long handler = rdp->timeStampDone - rdp->timeStampOut;
+    latencyStats_t* sp = &_latencyStats[rdp->repType];
+    core_util_critical_section_enter();
+    sp->count++;
+    sp->totalReport += report;
+    sp->totalWait += wait;
+    sp->totalHandler += handler;
+    if (report > sp->maxReport)
+    {
+        sp->maxReport = report;
+    }
+    if (wait > sp->maxWait)
+    {
+        sp->maxWait = wait;
+    }
+    if (handler > sp->maxHandler)
+    {
+        sp->maxHandler = handler;
+    }
+    core_util_critical_section_exit();
+}
+
+/**
+ Get latency statistics.
+ 
+ @param repType - event type
+ @param sp - pointer to where the statistics for the event type are to be copied
+ */
+void Reporter::getLatencyStats(EventType repType, latencyStats_t* sp)
+{
+    core_util_critical_section_enter();
+    *sp = _latencyStats[repType];
+    core_util_critical_section_exit();
+}
+
+/**
+ Reset latency statistics.
+ */
+void Reporter::resetLatencyStats()
+{
+    core_util_critical_section_enter();
+    memset(_latencyStats, 0, sizeof(_latencyStats));
+    core_util_critical_section_exit();
+}
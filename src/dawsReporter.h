@@ -26,10 +26,41 @@
 #ifndef ____dawsReporter__
 #define ____dawsReporter__
 
+#include "dawsSeqLock.h"
+#include "dawsEventTypes.h"
 
+#define REPORT_QUEUE_LEN 16 ///< report queue capacity
+#ifndef REPORT_LIMIT_LOW
+#define REPORT_LIMIT_LOW (REPORT_QUEUE_LEN * 5 / 8)     ///< queue depth at which CLASS_LOW reports are shed
+#endif
+#ifndef REPORT_LIMIT_NORMAL
+#define REPORT_LIMIT_NORMAL (REPORT_QUEUE_LEN - 2)      ///< queue depth at which CLASS_NORMAL reports are shed
+#endif
 
+#if REPORT_LIMIT_LOW > REPORT_LIMIT_NORMAL || REPORT_LIMIT_NORMAL > REPORT_QUEUE_LEN
+#error "report class limits must not decrease with importance"
+#endif
 
 
+
+// Reporter types - REPORTER_TYPE(id, type character).  The ReporterType enum and REPORTER_TYPE_COUNT
+// are made from this list, so per type tables, e.g. the handler profiles, cover every type.
+#define DAWS_REPORTER_TYPES \
+    REPORTER_TYPE(SERVO_REP, 'S')   /* servo reporter */ \
+    REPORTER_TYPE(MOTOR_REP, 'M')   /* motor state reporter  - reserved - not in use */ \
+    REPORTER_TYPE(VL53_REP, 'V')    /* IR time of flight distance sensor */ \
+    REPORTER_TYPE(NFC_REP, 'N')     /* Near Field Comms controller */ \
+    REPORTER_TYPE(NTAG_REP, 'U')    /* NFC NTAG Target */ \
+    REPORTER_TYPE(DEP_REP, 'D')     /* NFC DEP target */ \
+    REPORTER_TYPE(ODO_REP, 'O')     /* Odometer reporter */ \
+    REPORTER_TYPE(RA_REP, 'R')      /* Remote Accessory */ \
+    REPORTER_TYPE(ACC_REP, 'A')     /* Accessory reporter */ \
+    REPORTER_TYPE(QDEC_REP, 'Q')    /* Quadrature decoder reporter */ \
+    REPORTER_TYPE(AUTO_REP, 'L')    /* Loco Automaton Reporter */ \
+    REPORTER_TYPE(BLE_REP, 'B')     /* BLE reporter */ \
+    REPORTER_TYPE(LOOP_REP, 'T')    /* Periodic loop timing monitor */ \
+    REPORTER_TYPE(WCET_REP, 'W')    /* Execution time harness reporter */
+
 /**
 @brief Reporter Type
 
@@ -40,19 +71,18 @@ to permit access to the relevant class methods for inheriting classes.
  
  */
 enum ReporterType : char {
-    SERVO_REP   = 'S', ///< servo reporter
-    MOTOR_REP   = 'M', ///< motor state reporter  - reserved - not in use
-    VL53_REP    = 'V', ///< IR time of flight distance sensor
-    NFC_REP     = 'N', ///< Near Field Comms controller
-    NTAG_REP    = 'U', ///< NFC NTAG Target
-    DEP_REP     = 'D', ///< NFC DEP target
-    ODO_REP     = 'O', ///< Odometer reporter
-    RA_REP      = 'R', ///< Remote Accessory
-    ACC_REP     = 'A', ///< Accessory reporter
-    QDEC_REP    = 'Q', ///< Quadrature decoder reporter
-    AUTO_REP    = 'L', ///< Loco Automaton Reporter
-    BLE_REP     = 'B'  ///< BLE reporter
+#define REPORTER_TYPE(id, code) id = code,
+    DAWS_REPORTER_TYPES
+#undef REPORTER_TYPE
+};
+
+#define REPORTER_TYPE(id, code) + 1
+enum : byte
+{
+    REPORTER_TYPE_COUNT = 0 DAWS_REPORTER_TYPES    ///< number of reporter types
 };
+#undef REPORTER_TYPE
+
 /**
 @brief Report Type
 
@@ -60,50 +90,33 @@ enum ReporterType : char {
  
  @note some report types only apply to mobile sketch usage, others are static/accessory usage and some
  are common to both
+
+ The types and their descriptions are listed in dawsEventTypes.h.
  */
 enum EventType : byte
 {
-    REPORT_OVERRUN,      ///< previous report from this source has not been processed.
-    
-    LOCO_STOP,           ///< loco stopped
-    
-    VL53_RANGE_CLOSE,  ///<  distance read - below critical distance
-    VL53_RANGE_NORMAL,  ///< distance read - above critical distance
-    VL53_OUT_OF_RANGE,   ///< range read error indicating out of range
-    VL53_ERR,            ///< range read error indicating HW problem
-    
-    NTAG_NDEF,           ///< NFC ULTRALIGHT (NTAG21x) found with NDEF content
-    NTAG_NONDEF,         ///< NFC ULTRALIGHT (NTAG21x) found - null NDEF
-    
-    MIFARE_C1K_FOUND,    ///< NFC MIFARE CLASSIC 1K found
-    MIFARE_DEP_FOUND,    ///< DEP target found
-    MIFARE_DEP_MSG,      ///< DEP message received (either way)
-    MIFARE_DEP_PASSIVE,  ///< been found as a DEP passive target
-    
-    NFC_OTHER_FOUND,     ///< NFC other recognised tag found
-    NFC_TAG_TYPE_UNKNOWN,///<NFC tag found - type unknown
-    
-    RA_DISCOVERED,       ///< Discovered Accessory for this remote
-    RA_STATE_CHANGE,     ///< Remote accessory status update
-    RA_CONNECTED,        ///< Remote accessory now connected
-    RA_DISCONNECTED,     ///<Remote accessory disconnected
-    
-    BLE_SCAN_START,      ///<BLE Scan started
-    BLE_SCAN_DONE,       ///< BLE Scan completed
-    
-    BLE_PEER_FOUND,      ///< BLE peer found by scan
-    BLE_CONNECTED,       ///< BLE - client (central) connection to peer made but discovery/service init required
-    BLE_SERVICES_AVAIL,  ///< BLE -  client (central) connection completely open - services ready
-    BLE_CONNECT_FAIL,    ///< BLE -  client (central) connection open failed
-    BLE_DISCONNECTED,    ///< BLE - client (central) disconnected
-    
-    ACC_STATE_CHANGE,    ///< Local accessory status update
-    ROTQ_ROT,            ///< Rotary switch rotation
-    ROTQ_ERR,            ///<Rotary switch double change (error)
-    ///
-    SET_AUTO              ///<Set Loco Driver Auto mode
-    
-    ///
+#define EVENT_TYPE(id) id,
+    DAWS_EVENT_TYPES
+#undef EVENT_TYPE
+    EVENT_TYPE_COUNT      ///< number of event types - must be last
+};
+
+#define EVENT_BIT(e) ((uint32_t)1 << (e))   ///< event type bit in an event mask
+
+
+/**
+ @brief Report importance class
+
+ Each event type has a class.  As the report queue fills, the slots above REPORT_LIMIT_LOW are kept for
+ normal and critical reports and those above REPORT_LIMIT_NORMAL for critical reports only, so a
+ safety report always finds a slot when routine reports are flooding the queue.
+ */
+enum ReportClass : byte
+{
+    CLASS_LOW,          ///< routine, e.g. scan progress or a normal range - shed first
+    CLASS_NORMAL,       ///< most reports
+    CLASS_CRITICAL,     ///< safety, e.g. range close - only shed if the queue is full
+    REPORT_CLASS_COUNT  ///< number of classes - must be last
 };
 
 
@@ -119,11 +132,56 @@ typedef struct
 {
     EventType repType;  ///< type of report
     Reporter* source;    ///< reporter based object initiating report
+    unsigned long timeStampEvent; ///< time of the event - as given by the originator or else time added to queue
     unsigned long timeStampIn; ///< time added to queue
     unsigned long timeStampOut; ///< time removed from queue
+    unsigned long timeStampDone; ///< time handling completed - set by markHandled
     int info; ///< addition information - usage depends on report type
 } report_t;
 
+/**
+ @brief Report latency statistics
+
+ Aggregated for each event type from reports marked as handled.
+ - report - from the event to adding the report to the queue
+ - wait - from adding the report to the queue to removing it
+ - handler - from removing the report from the queue to handling completed
+ */
+typedef struct
+{
+    uint32_t count;             ///< number of reports handled
+    unsigned long maxReport;    ///< maximum event to queue time (us)
+    unsigned long maxWait;      ///< maximum queue wait time (us)
+    unsigned long maxHandler;   ///< maximum handler time (us)
+    uint64_t totalReport;       ///< total event to queue time (us) - for average
+    uint64_t totalWait;         ///< total queue wait time (us) - for average
+    uint64_t totalHandler;      ///< total handler time (us) - for average
+} latencyStats_t;
+
+/**
+ @brief Latest value
+
+ The latest value published by a reporter.
+ */
+typedef struct
+{
+    int value;                  ///< value - usage depends on reporter type
+    unsigned long timeStamp;    ///< time published
+} latest_t;
+
+/**
+ @brief Reporter state
+
+ A reporter's published state as captured by a snapshot.
+ */
+typedef struct
+{
+    Reporter* source;   ///< reporter
+    byte id;            ///< reporter id
+    ReporterType type;  ///< reporter type
+    bool valid;         ///< true if the reporter has published a value
+    latest_t latest;    ///< latest published value
+} repState_t;
 
 
 /**
@@ -134,18 +192,52 @@ typedef struct
  
  When a device manager or similar detects a significant event this event is reported.  Event reports are inserted by reference into an rtos queue.
  Many devices may detect and report events.  The report queue has a fixed capaccity.  
+ Reports are admitted by the importance class of their event type.  Once the queue is
+ above the limit for a report's class the report is shed and counted.  The first report of a class
+ shed since one was last admitted is logged (LOG_SHED, or LOG_QUEUE_FULL for a critical report).
  
  There is a single reader for events which processes them in sequence.
+ The reader calls markHandled when it has finished with each report.  Each report then has
+ event, enqueue, dequeue and completion times so its event to queue, queue wait and handler
+ times are aggregated by event type.
  
  Reporters are chained together.  Each holding a
  link to the next in the chain, except for the
  last.  These links are created when reporters
  are constructed.  There is a static class
  variable holding the pointer to the first
- reporter.  This allows high level code
+ reporter.  The chain and counters are constant
+ initialised and the report queue is made by the
+ first reporter constructed, so reporters may be
+ constructed in any translation unit in any order.  This allows high level code
  to cycle through reporters without needing
  explicit reference to any.
 
+ A reporter may also publish its latest value (e.g. range, voltage, speed)
+ in a sequence lock protected cell.  Readers that only want the latest value
+ poll this without locks and without using the report queue.  Significant events
+ such as threshold crossings are still reported via the queue.
+ A snapshot of all reporters' latest values may be taken at a single
+ consistent instant.
+
+ Sampling reporters may be asked to reduce their rate by setRateLevel(), e.g. by the
+ Governor when the report queue is filling.  Level 0 is full rate and each level above
+ should about halve it.  A reporter either checks getRateLevel() each sample period or
+ overrides setRateLevel() to reprogram its timing.
+
+ A reporter may be muted, e.g. the rear VL53 while running forward.  Its reports are then
+ discarded before they use a queue slot.  A reporter that overrides muteChanged() may
+ also stop sampling.
+
+ A reporter that declares the event types it reports, by getEventMask(), is activated
+ lazily.  Its setup() is called when the first consumer subscribes to one of its
+ event types, or it is activated explicitly, rather than at boot.  When no
+ subscriptions or activations remain it is put to sleep by activeChanged(false), and woken
+ again by activeChanged(true).  Reporters with an empty mask are set up by the application
+ as before.  The mask cannot be read while a reporter is constructed, so a reporter constructed
+ after a subscription to one of its event types is activated by the next subscribe(), unsubscribe(),
+ activate() or release().  Subscription and demand counts stick at 255 once reached.
+
  
  
  @note Reporter based class objects are not copyable
@@ -157,6 +249,14 @@ public:
     Reporter(ReporterType);
     Reporter(ReporterType, byte);
     virtual void setup();
+    virtual uint32_t getEventMask();
+    virtual void activeChanged(bool);
+    void activate();
+    void release();
+    bool isActive();
+    static void subscribe(EventType);
+    static void unsubscribe(EventType);
+    static byte getSubscribers(EventType);
 
     Reporter* getNextReporter();
     static Reporter* getFirstReporter();
@@ -171,24 +271,64 @@ public:
     *********************************/
     virtual ReporterType getType() = 0;
     void queueReport(EventType, int);
-    uint16_t getQueueFullCount(); ///< not implemented yet
+    void queueReport(EventType, int, unsigned long);
+    static uint16_t getQueueFullCount();
+    static uint32_t getShedCount(ReportClass);
+    static ReportClass getEventClass(EventType);
+    static void setEventClass(EventType, ReportClass);
+    static byte getQueueDepth();
+    static byte takeQueuePeak();
+    virtual void setRateLevel(byte);
+    byte getRateLevel();
+    void mute();
+    void resume();
+    bool isMuted();
+    virtual void muteChanged(bool);
     static bool tryGetReport(report_t*);
     static bool tryGetReport(report_t*, rtos::Kernel::Clock::duration_u32 );
+    static void markHandled(report_t*);
+    static void getLatencyStats(EventType, latencyStats_t*);
+    static void resetLatencyStats();
+    void publishLatest(int);
+    bool getLatest(latest_t*);
+    static bool snapshot(repState_t*, byte, byte*);
 
     
 private:
-    static rtos::Mail<report_t, 16> _reportQueue;  // report queue
+    static rtos::Mail<report_t, REPORT_QUEUE_LEN>* _reportQueue;  // report queue - nullptr until made
+    static volatile uint8_t _queueState;         // report queue construction state
+
+    static volatile uint16_t _queueFullCount;    // count of reports dropped
+    static volatile uint32_t _shedCount[REPORT_CLASS_COUNT];    // reports dropped by class
+    static volatile bool _shedding[REPORT_CLASS_COUNT];         // class shed since last admitted - logged once
+    static ReportClass _eventClass[EVENT_TYPE_COUNT];           // class of each event type
+    static volatile uint8_t _queueDepth;         // reports allocated and not yet retrieved
+    static volatile uint8_t _queuePeak;          // highest depth since last taken
+    static volatile uint32_t _publishEpoch;      // publication count - odd while publish in progress
+    static latencyStats_t _latencyStats[EVENT_TYPE_COUNT];  // latency statistics by event type
 
-    static volatile uint16_t _queueFullCount;    // count of report queue full incidents
 
+    SeqLock<latest_t> _latest;  ///< latest published value
 
     Reporter* _nextReporter;    ///< pointer to next reporter in chain
     byte _id;       ///< unique id
+    volatile byte _rateLevel;   ///< rate reduction requested - 0 for full rate
+    volatile bool _muted;       ///< reports discarded before queueing
+    byte _demand;               ///< subscribed event types plus explicit activations
+    bool _active;               ///< activated and not asleep
+    bool _setupDone;            ///< setup() called
+    static byte _subscribers[EVENT_TYPE_COUNT];  // subscriber count by event type
+    void _demandChanged(bool);  ///< count demand up or down
     static byte _lastId;  ///< last allocated id
     //ReporterType _type;
     static Reporter* _lastInstantiated;  ///< pointer to the last reporter to be constructed
     static Reporter* _firstReporter;     ///< pointer to first reporter in the chain
+    static Reporter* _unmasked;          ///< first reporter whose event mask has not been read - nullptr if none
+    static void _activateLate();         ///< count subscriptions made before reporters were constructed
     void _link(Reporter*);  ///< link this to next reporter in chain
+    void _register();       ///< add this to the chain
+    static void _makeQueue();   ///< construct the report queue if not yet made
+    void _queue(EventType, int, unsigned long, bool);  ///< add report to queue
 };
 
 
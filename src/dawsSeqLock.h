@@ -0,0 +1,113 @@
+//
+/**
+ @file dawsSeqLock.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsSeqLock__
+#define ____dawsSeqLock__
+
+/**
+ @brief Sequence lock protected value
+
+ This holds a value that is written by producers, including ISRs, and read by any
+ thread without locks.
+
+ The sequence number is odd while a write is in progress.  A reader takes the sequence
+ number, copies the value and then checks that the sequence number is unchanged and even.  If
+ not the copy may be torn and is retried.
+
+ The write is done with interrupts disabled for the few instructions it takes so any number of
+ producers, in threads or ISRs, may write.  Writes never wait.  Readers never disable interrupts.
+ As a reader can not pre-empt a write in progress a reader can only need to retry if a write
+ completes while it is copying.
+
+ @note T must be trivially copyable.  Keep it small - it is copied with interrupts disabled.
+ */
+template <typename T>
+class SeqLock: mbed::NonCopyable<SeqLock<T> >
+{
+public:
+    /**
+     @brief Construct sequence lock
+
+     The value is zero initialised and the sequence number is 0 to show it has never been written.
+     */
+    constexpr SeqLock(): _seq(0), _value()
+    {
+    }
+
+    /**
+     @brief Write value
+
+     Callable from ISR.
+
+     @param value - the new value
+     */
+    void write(const T& value)
+    {
+        core_util_critical_section_enter();
+        core_util_atomic_store_u32(&_seq, _seq + 1);  // odd - write in progress
+        memcpy((void*)&_value, &value, sizeof(T));
+        core_util_atomic_store_u32(&_seq, _seq + 1);  // even - write complete
+        core_util_critical_section_exit();
+    }
+
+    /**
+     @brief Read value
+
+     Callable from ISR.
+
+     @param value - pointer to where the value is to be copied
+
+     @return the sequence number of the value read.  0 if it has never been written.
+     */
+    uint32_t read(T* value) const
+    {
+        uint32_t seq;
+        do
+        {
+            seq = core_util_atomic_load_u32(&_seq);
+            memcpy(value, (const void*)&_value, sizeof(T));
+        }
+        while ((seq & 1) != 0 || core_util_atomic_load_u32(&_seq) != seq);
+        return(seq);
+    }
+
+    /**
+     @brief Get sequence number
+
+     The sequence number increases by 2 for each write.
+
+     @return the current sequence number
+     */
+    uint32_t getSequence() const
+    {
+        return(core_util_atomic_load_u32(&_seq));
+    }
+
+private:
+    volatile uint32_t _seq;     ///< sequence number - odd while write in progress
+    volatile T _value;          ///< protected value
+};
+
+#endif /* defined(____dawsSeqLock__) */
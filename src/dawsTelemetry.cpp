@@ -0,0 +1,252 @@
+/**
+@file dawsTelemetry.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLoopMonitor.h"
+#include "dawsProfile.h"
+#include "dawsThreadStats.h"
+#include "dawsTelemetry.h"
+
+#if PROFILE_HIST_BINS != TLM_HIST_BINS || LOOP_HIST_BINS != TLM_HIST_BINS
+#error "telemetry histogram size does not match"
+#endif
+static_assert(REPORT_CLASS_COUNT == TLM_CLASS_COUNT, "telemetry class count does not match");
+
+/**
+ @brief Telemetry thread stack
+
+ Statically allocated so the thread does not take its stack from the heap.
+ */
+MBED_ALIGN(8) static unsigned char telemetryStack[TELEMETRY_STACK_SIZE];
+
+uint8_t Telemetry::_frame[TLM_HEADER_LEN + TLM_MAX_PAYLOAD + 2];
+uint32_t Telemetry::_cycle = 0;
+Print* Telemetry::_out = nullptr;
+rtos::Thread Telemetry::_thread(TELEMETRY_PRIORITY, TELEMETRY_STACK_SIZE, telemetryStack, "telemetry");
+
+/**
+ @brief Start telemetry thread
+
+ Start the thread sending a cycle every TELEMETRY_PERIOD ms.  It runs at TELEMETRY_PRIORITY.
+
+ @param out - where to send, e.g. &Serial
+ */
+void Telemetry::start(Print* out)
+{
+    _out = out;
+    _thread.start(_run);
+}
+
+/**
+ @brief Send one cycle
+
+ Send the cycle frame then the frames for each event type with reports, each handler profile, each
+ loop monitor and each registered thread.
+
+ @param out - where to send, e.g. Serial
+
+ @return number of frames sent
+
+ @note Only one thread may send.
+ */
+uint32_t Telemetry::send(Print& out)
+{
+    uint32_t frames = 0;
+
+    tlmCycle_t cycle;
+    cycle.time = micros();
+    cycle.cycle = _cycle++;
+    cycle.queueFull = Reporter::getQueueFullCount();
+    cycle.queueLen = REPORT_QUEUE_LEN;
+    cycle.version = TLM_VERSION;
+    cycle.otherSamples = ThreadStats::getOtherSamples();
+    cycle.totalSamples = ThreadStats::getTotalSamples();
+    for (int c = 0; c < TLM_CLASS_COUNT; c++)
+    {
+        cycle.shed[c] = Reporter::getShedCount((ReportClass)c);
+    }
+    _send(out, TLM_CYCLE, &cycle, sizeof(cycle));
+    frames++;
+
+    latencyStats_t stats;
+    tlmLatency_t latency;
+    memset(&latency, 0, sizeof(latency));
+    for (int e = 0; e < EVENT_TYPE_COUNT; e++)
+    {
+        Reporter::getLatencyStats((EventType)e, &stats);
+        if (stats.count == 0)
+        {
+            continue;
+        }
+        latency.eventType = e;
+        latency.count = stats.count;
+        latency.maxReport = stats.maxReport;
+        latency.maxWait = stats.maxWait;
+        latency.maxHandler = stats.maxHandler;
+        latency.meanReport = stats.totalReport / stats.count;
+        latency.meanWait = stats.totalWait / stats.count;
+        latency.meanHandler = stats.totalHandler / stats.count;
+        _send(out, TLM_LATENCY, &latency, sizeof(latency));
+        frames++;
+    }
+
+    handlerProfile_t handler;
+    tlmProfile_t profile;
+    memset(&profile, 0, sizeof(profile));
+    for (int e = 0; e < EVENT_TYPE_COUNT; e++)
+    {
+        if (!ReportProfiler::getEventProfile((EventType)e, &handler) || handler.count == 0)
+        {
+            continue;
+        }
+        profile.eventType = e;
+        profile.count = handler.count;
+        profile.max = handler.max;
+        profile.mean = handler.total / handler.count;
+        memcpy(profile.hist, handler.hist, sizeof(profile.hist));
+        _send(out, TLM_PROFILE, &profile, sizeof(profile));
+        frames++;
+    }
+
+    loopStats_t loopStats;
+    tlmLoop_t loop;
+    for (Reporter* rp = Reporter::getFirstReporter(); rp != nullptr; rp = rp->getNextReporter())
+    {
+        if (rp->getType() != LOOP_REP)
+        {
+            continue;
+        }
+        LoopMonitor* lp = static_cast<LoopMonitor*>(rp);
+        lp->getStats(&loopStats);
+        loop.id = lp->getId();
+        _name(loop.name, lp->getName(), sizeof(loop.name));
+        loop.period = lp->getPeriod();
+        loop.iterations = loopStats.iterations;
+        loop.misses = loopStats.misses;
+        loop.minPeriod = loopStats.minPeriod;
+        loop.maxPeriod = loopStats.maxPeriod;
+        loop.maxExec = loopStats.maxExec;
+        loop.meanExec = (loopStats.iterations == 0) ? 0 : loopStats.totalExec / loopStats.iterations;
+        loop.worstLateness = loopStats.worstLateness;
+        memcpy(loop.jitter, loopStats.jitter, sizeof(loop.jitter));
+        _send(out, TLM_LOOP, &loop, sizeof(loop));
+        frames++;
+    }
+
+    threadStats_t threadStats;
+    tlmThread_t thread;
+    memset(&thread, 0, sizeof(thread));
+    for (byte i = 0; ThreadStats::getStats(i, &threadStats); i++)
+    {
+        thread.index = i;
+        thread.reporterType = (threadStats.reporter != nullptr) ? threadStats.reporter->getType() : 0;
+        thread.reporterId = (threadStats.reporter != nullptr) ? threadStats.reporter->getId() : 0;
+        _name(thread.name, threadStats.name, sizeof(thread.name));
+        thread.samples = threadStats.samples;
+        thread.switches = threadStats.switches;
+        thread.cpuTime = threadStats.cpuTime;
+        thread.cpuPermille = threadStats.cpuPermille;
+        thread.stackSize = threadStats.stackSize;
+        thread.stackMax = threadStats.stackMax;
+        _send(out, TLM_THREAD, &thread, sizeof(thread));
+        frames++;
+    }
+    return(frames);
+}
+
+/**
+ @brief Get cycle count
+
+ @return number of cycles sent
+ */
+uint32_t Telemetry::getCycles()
+{
+    return(_cycle);
+}
+
+/*********************************
+ _send
+ *********************************
+
+ Build a frame round the payload in the frame buffer and write it in
+ one call.
+
+ parameters  - where to send, type, payload, payload length
+
+ returns none
+ *********************************/
+void Telemetry::_send(Print& out, byte type, const void* payload, byte length)
+{
+    _frame[0] = TLM_SYNC0;
+    _frame[1] = TLM_SYNC1;
+    _frame[2] = type;
+    _frame[3] = length;
+    memcpy(_frame + TLM_HEADER_LEN, payload, length);
+    uint16_t crc = tlmCrc(0xffff, _frame + 2, TLM_HEADER_LEN - 2 + length);
+    _frame[TLM_HEADER_LEN + length] = crc & 0xff;
+    _frame[TLM_HEADER_LEN + length + 1] = crc >> 8;
+    out.write(_frame, TLM_HEADER_LEN + length + 2);
+}
+
+/*********************************
+ _name
+ *********************************
+
+ Copy a name, truncated and nul padded.
+
+ parameters  - destination, name (may be nullptr), destination size
+
+ returns none
+ *********************************/
+void Telemetry::_name(char* dest, const char* name, byte size)
+{
+    memset(dest, 0, size);
+    if (name != nullptr)
+    {
+        memcpy(dest, name, strnlen(name, size));
+    }
+}
+
+/*********************************
+ _run
+ *********************************
+
+ Telemetry thread.  Send a cycle every TELEMETRY_PERIOD ms.
+
+ parameters  - none
+
+ returns never
+ *********************************/
+void Telemetry::_run()
+{
+    while (true)
+    {
+        send(*_out);
+        rtos::ThisThread::sleep_for(rtos::Kernel::Clock::duration_u32(TELEMETRY_PERIOD));
+    }
+}
@@ -0,0 +1,74 @@
+//
+/**
+ @file dawsTelemetry.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsTelemetry__
+#define ____dawsTelemetry__
+
+#include "dawsTelemetryFormat.h"
+
+#ifndef TELEMETRY_PERIOD
+#define TELEMETRY_PERIOD 1000           ///< telemetry thread period (ms)
+#endif
+#ifndef TELEMETRY_STACK_SIZE
+#define TELEMETRY_STACK_SIZE 1024       ///< telemetry thread stack size
+#endif
+#ifndef TELEMETRY_PRIORITY
+#define TELEMETRY_PRIORITY osPriorityLow    ///< telemetry thread priority
+#endif
+
+/**
+ @brief Binary telemetry
+
+ Sends the report latency statistics, handler profiles, loop monitor statistics and thread statistics
+ as binary frames (dawsTelemetryFormat.h) rather than formatted text, so monitoring takes little time
+ from the threads it measures.  Each frame is built in a static buffer and written in one call.  Nothing is
+ formatted or allocated on the target.
+
+ send() sends one cycle.  start() starts a low priority thread sending a cycle every TELEMETRY_PERIOD ms.
+ extras/tools/dawsTelemetryView.cpp decodes and displays the frames on the host.
+
+ @note The output should not be shared with text output.  The viewer skips text but may lose frames
+ interleaved with it.
+
+ @note This is a static class.
+ */
+class Telemetry
+{
+public:
+    static void start(Print*);
+    static uint32_t send(Print&);
+    static uint32_t getCycles();
+
+private:
+    static uint8_t _frame[TLM_HEADER_LEN + TLM_MAX_PAYLOAD + 2];    // frame being sent
+    static uint32_t _cycle;                                         // cycles sent
+    static Print* _out;                                             // output of thread
+    static rtos::Thread _thread;                                    // telemetry thread
+    static void _send(Print&, byte, const void*, byte);             // frame and send payload
+    static void _name(char*, const char*, byte);                    // copy name
+    static void _run();                                             // telemetry thread
+};
+
+#endif /* defined(____dawsTelemetry__) */
@@ -0,0 +1,183 @@
+//
+/**
+ @file dawsTelemetryFormat.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+
+ @brief Binary telemetry framing
+
+ The frames sent by Telemetry (dawsTelemetry.h) and read on the host by extras/tools/dawsTelemetryView.cpp,
+ which includes this file.  It must therefore only use standard headers.  All values are little endian.
+
+ Each frame is
+
+ - TLM_SYNC0, TLM_SYNC1
+ - type (tlmType_t)
+ - payload length
+ - payload - the struct for the type
+ - CRC-16/CCITT of the type, length and payload, low byte first
+
+ Each cycle starts with a TLM_CYCLE frame, followed by a frame for each event type with reports, each
+ event type's handler profile if profiling is enabled, each loop monitor and each registered thread.
+ Add new types at the end and new fields at the end of a payload so older viewers can skip them.
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsTelemetryFormat__
+#define ____dawsTelemetryFormat__
+
+#include <stdint.h>
+
+#define TLM_SYNC0 0xa5          ///< first sync byte
+#define TLM_SYNC1 0x5a          ///< second sync byte
+#define TLM_VERSION 1           ///< frame layout version
+#define TLM_HEADER_LEN 4        ///< sync, type and length
+#define TLM_MAX_PAYLOAD 128     ///< largest payload
+#define TLM_HIST_BINS 16        ///< histogram bins - as PROFILE_HIST_BINS and LOOP_HIST_BINS
+#define TLM_NAME_LEN 12         ///< name length - nul terminated if shorter
+#define TLM_CLASS_COUNT 3       ///< report importance classes - as REPORT_CLASS_COUNT
+
+/**
+ @brief Frame types
+ */
+typedef enum
+{
+    TLM_CYCLE,      ///< tlmCycle_t
+    TLM_LATENCY,    ///< tlmLatency_t
+    TLM_PROFILE,    ///< tlmProfile_t
+    TLM_LOOP,       ///< tlmLoop_t
+    TLM_THREAD,     ///< tlmThread_t
+    TLM_TYPE_COUNT  ///< number of types - must be last
+} tlmType_t;
+
+/**
+ @brief Start of cycle
+ */
+typedef struct
+{
+    uint32_t time;          ///< time sent - micros()
+    uint32_t cycle;         ///< cycle number from 0
+    uint16_t queueFull;     ///< reports dropped
+    uint8_t queueLen;       ///< report queue capacity
+    uint8_t version;        ///< TLM_VERSION
+    uint32_t otherSamples;  ///< thread samples when no registered thread ran
+    uint32_t totalSamples;  ///< all thread samples
+    uint32_t shed[TLM_CLASS_COUNT]; ///< reports dropped by importance class - low, normal, critical
+} tlmCycle_t;
+
+/**
+ @brief Report latency of an event type
+
+ As Reporter::getLatencyStats().  Means are rounded down.
+ */
+typedef struct
+{
+    uint8_t eventType;      ///< EventType
+    uint8_t reserved[3];    ///< 0
+    uint32_t count;         ///< reports handled
+    uint32_t maxReport;     ///< event to queue (us)
+    uint32_t maxWait;       ///< queue wait (us)
+    uint32_t maxHandler;    ///< handler (us)
+    uint32_t meanReport;
+    uint32_t meanWait;
+    uint32_t meanHandler;
+} tlmLatency_t;
+
+/**
+ @brief Handler profile of an event type
+
+ As ReportProfiler::getEventProfile().
+ */
+typedef struct
+{
+    uint8_t eventType;              ///< EventType
+    uint8_t reserved[3];            ///< 0
+    uint32_t count;                 ///< reports handled
+    uint32_t max;                   ///< longest handler time (us)
+    uint32_t mean;                  ///< mean handler time (us)
+    uint32_t hist[TLM_HIST_BINS];   ///< power of two histogram
+} tlmProfile_t;
+
+/**
+ @brief Loop monitor
+
+ As LoopMonitor::getStats().
+ */
+typedef struct
+{
+    uint8_t id;                     ///< reporter id
+    char name[TLM_NAME_LEN - 1];    ///< loop name
+    uint32_t period;                ///< nominal period (us)
+    uint32_t iterations;
+    uint32_t misses;
+    uint32_t minPeriod;             ///< (us)
+    uint32_t maxPeriod;             ///< (us)
+    uint32_t maxExec;               ///< (us)
+    uint32_t meanExec;              ///< (us)
+    uint32_t worstLateness;         ///< (us)
+    uint32_t jitter[TLM_HIST_BINS]; ///< power of two histogram
+} tlmLoop_t;
+
+/**
+ @brief Thread
+
+ As ThreadStats::getStats().
+ */
+typedef struct
+{
+    uint8_t index;              ///< registration index
+    uint8_t reporterType;       ///< ReporterType of the thread's reporter - 0 if none
+    uint8_t reporterId;         ///< its id
+    uint8_t reserved;           ///< 0
+    char name[TLM_NAME_LEN];    ///< thread name
+    uint32_t samples;
+    uint32_t switches;
+    uint32_t cpuTime;           ///< (us)
+    uint16_t cpuPermille;
+    uint16_t reserved2;         ///< 0
+    uint32_t stackSize;         ///< (bytes)
+    uint32_t stackMax;          ///< high water mark (bytes)
+} tlmThread_t;
+
+/**
+ @brief CRC
+
+ CRC-16/CCITT-FALSE - polynomial 0x1021, initial 0xffff.
+
+ @param crc - CRC so far - 0xffff to start
+ @param p - data
+ @param length - number of bytes
+
+ @return CRC
+ */
+static inline uint16_t tlmCrc(uint16_t crc, const uint8_t* p, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)p[i] << 8;
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return(crc);
+}
+
+#endif /* defined(____dawsTelemetryFormat__) */
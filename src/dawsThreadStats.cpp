@@ -0,0 +1,238 @@
+/**
+@file dawsThreadStats.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsThreadStats.h"
+
+mbed::Ticker ThreadStats::_ticker;
+osThreadId_t ThreadStats::_ids[THREAD_STATS_MAX];
+Reporter* ThreadStats::_reporters[THREAD_STATS_MAX];
+volatile uint32_t ThreadStats::_samples[THREAD_STATS_MAX];
+volatile uint32_t ThreadStats::_switches[THREAD_STATS_MAX];
+volatile uint32_t ThreadStats::_otherSamples = 0;
+volatile uint32_t ThreadStats::_totalSamples = 0;
+volatile byte ThreadStats::_count = 0;
+osThreadId_t ThreadStats::_lastRunning = nullptr;
+
+/**
+ @brief Register thread
+
+ Register a thread for accounting.
+
+ @param id - thread id, e.g. from rtos::Thread::get_id() or rtos::ThisThread::get_id()
+ @param reporter - the reporter the thread runs for or nullptr
+
+ @return true if registered.  False if already registered or too many threads.
+
+ @note This is a static function
+ */
+bool ThreadStats::registerThread(osThreadId_t id, Reporter* reporter)
+{
+    if (id == nullptr)
+    {
+        return(false);
+    }
+    bool registered = false;
+    core_util_critical_section_enter();
+    byte n = _count;
+    for (byte i = 0; i < n; i++)
+    {
+        if (_ids[i] == id)
+        {
+            n = THREAD_STATS_MAX;  // already registered
+        }
+    }
+    if (n < THREAD_STATS_MAX)
+    {
+        _ids[n] = id;
+        _reporters[n] = reporter;
+        _samples[n] = 0;
+        _switches[n] = 0;
+        _count = n + 1;  // sampler sees the new entry only when complete
+        registered = true;
+    }
+    core_util_critical_section_exit();
+    return(registered);
+}
+
+/**
+ @brief Start sampling
+
+ @note This is a static function
+ */
+void ThreadStats::start()
+{
+    _ticker.attach(_sample, std::chrono::microseconds(THREAD_SAMPLE_US));
+}
+
+/**
+ @brief Stop sampling
+
+ @note This is a static function
+ */
+void ThreadStats::stop()
+{
+    _ticker.detach();
+}
+
+/**
+ @brief Reset
+
+ Clear the sample counts.  Registrations are kept.
+
+ @note This is a static function
+ */
+void ThreadStats::reset()
+{
+    core_util_critical_section_enter();
+    for (byte i = 0; i < _count; i++)
+    {
+        _samples[i] = 0;
+        _switches[i] = 0;
+    }
+    _otherSamples = 0;
+    _totalSamples = 0;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Get count
+
+ @return number of registered threads
+
+ @note This is a static function
+ */
+byte ThreadStats::getCount()
+{
+    return(_count);
+}
+
+/**
+ @brief Get statistics
+
+ @param index - index of registered thread from 0 to getCount() - 1
+ @param sp - pointer to where the statistics are to be returned
+
+ @return true if index valid
+
+ @note This is a static function
+ */
+bool ThreadStats::getStats(byte index, threadStats_t* sp)
+{
+    if (index >= _count)
+    {
+        return(false);
+    }
+    core_util_critical_section_enter();
+    sp->samples = _samples[index];
+    sp->switches = _switches[index];
+    uint32_t total = _totalSamples;
+    core_util_critical_section_exit();
+    sp->id = _ids[index];
+    sp->name = osThreadGetName(sp->id);
+    sp->reporter = _reporters[index];
+    sp->cpuTime = sp->samples * THREAD_SAMPLE_US;
+    sp->cpuPermille = (total == 0) ? 0 : (uint16_t)(((uint64_t)sp->samples * 1000) / total);
+    sp->stackSize = osThreadGetStackSize(sp->id);
+    sp->stackMax = sp->stackSize - osThreadGetStackSpace(sp->id);
+    return(true);
+}
+
+/**
+ @brief Get other samples
+
+ @return number of samples in which no registered thread was running, e.g. idle or ISR
+
+ @note This is a static function
+ */
+uint32_t ThreadStats::getOtherSamples()
+{
+    return(_otherSamples);
+}
+
+/**
+ @brief Get total samples
+
+ @return number of samples taken since start or reset
+
+ @note This is a static function
+ */
+uint32_t ThreadStats::getTotalSamples()
+{
+    return(_totalSamples);
+}
+
+/**
+ @brief Sample
+
+ Take one sample as the Ticker does, e.g. so a test can time sampling or check it does not use the heap.
+ The sample is counted in the statistics.
+
+ @note callable from ISR
+ @note This is a static function
+ */
+void ThreadStats::sample()
+{
+    _sample();
+}
+
+/*********************************
+ _sample
+ *********************************
+
+ Ticker ISR.  The thread interrupted is the running thread.
+ Attribute the sample to it.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+void ThreadStats::_sample()
+{
+    osThreadId_t running = osThreadGetId();
+    _totalSamples++;
+    byte n = _count;
+    byte i = 0;
+    while (i < n && _ids[i] != running)
+    {
+        i++;
+    }
+    if (i < n)
+    {
+        _samples[i]++;
+        if (running != _lastRunning)
+        {
+            _switches[i]++;
+        }
+    }
+    else
+    {
+        _otherSamples++;
+    }
+    _lastRunning = running;
+}
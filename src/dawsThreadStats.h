@@ -0,0 +1,101 @@
+//
+/**
+ @file dawsThreadStats.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsThreadStats__
+#define ____dawsThreadStats__
+
+#ifndef THREAD_STATS_MAX
+#define THREAD_STATS_MAX 12     ///< maximum number of threads that may be registered
+#endif
+#ifndef THREAD_SAMPLE_US
+#define THREAD_SAMPLE_US 499    ///< sample period (us) - prime so as not to alias with periodic threads
+#endif
+
+/**
+ @brief Thread statistics
+
+ CPU time is estimated by sampling.  It is the number of samples in which the thread was
+ running multiplied by the sample period.
+
+ Switches is the number of samples in which the thread was running when another thread was
+ running at the previous sample.  It is a lower bound on the number of context switches into the thread.
+
+ The stack high water mark is the most stack the thread has used.  It relies on the rtos filling stacks
+ with a pattern when threads are created, which it does if stack statistics are enabled.
+ */
+typedef struct
+{
+    osThreadId_t id;        ///< thread id
+    const char* name;       ///< thread name
+    Reporter* reporter;     ///< reporter the thread runs for - nullptr if none
+    uint32_t samples;       ///< samples in which the thread was running
+    uint32_t switches;      ///< observed switches into the thread
+    uint32_t cpuTime;       ///< estimated CPU time (us)
+    uint16_t cpuPermille;   ///< share of CPU time in parts per thousand
+    uint32_t stackSize;     ///< stack size (bytes)
+    uint32_t stackMax;      ///< stack high water mark (bytes)
+} threadStats_t;
+
+/**
+ @brief Per thread CPU time and stack accounting
+
+ Threads are registered, optionally against the reporter they run for.  A Ticker samples the running
+ thread so CPU time may be attributed to registered threads without changes to the rtos.
+ Samples when no registered thread is running, including the idle thread, are counted as other.
+
+ Use the statistics to right size thread stacks.
+
+ @note Register a thread after it has been started.
+
+ @note This is a static class.
+ */
+class ThreadStats
+{
+public:
+    static bool registerThread(osThreadId_t, Reporter*);
+    static void start();
+    static void stop();
+    static void reset();
+    static byte getCount();
+    static bool getStats(byte, threadStats_t*);
+    static uint32_t getOtherSamples();
+    static uint32_t getTotalSamples();
+    static void sample();
+
+private:
+    static mbed::Ticker _ticker;                        // sample ticker
+    static osThreadId_t _ids[THREAD_STATS_MAX];         // registered thread ids
+    static Reporter* _reporters[THREAD_STATS_MAX];      // reporter for each thread
+    static volatile uint32_t _samples[THREAD_STATS_MAX];    // running samples
+    static volatile uint32_t _switches[THREAD_STATS_MAX];   // observed switches
+    static volatile uint32_t _otherSamples;             // samples when no registered thread running
+    static volatile uint32_t _totalSamples;             // all samples
+    static volatile byte _count;                        // number registered
+    static osThreadId_t _lastRunning;                   // thread running at last sample
+
+    static void _sample();                              // sample ISR
+};
+
+#endif /* defined(____dawsThreadStats__) */
@@ -0,0 +1,385 @@
+/**
+@file dawsTrace.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.b
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//  Version 0.b Compressed chunks and streaming
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsTrace.h"
+
+traceChunk_t Trace::_chunks[TRACE_CHUNKS];
+traceCodec_t Trace::_codec;
+traceName_t Trace::_names[TRACE_MAX_NAMES];
+byte Trace::_nameCount = 0;
+uint32_t Trace::_seq = 0;
+uint32_t Trace::_sent = 0;
+uint32_t Trace::_session = 0;
+uint32_t Trace::_lost = 0;
+bool Trace::_namesSent = false;
+volatile bool Trace::_running = false;
+
+/**
+ @brief Start recording
+
+ The chunks are emptied and a new session started.
+ */
+void Trace::start()
+{
+    core_util_critical_section_enter();
+    _session = micros();
+    _codec.time = _session;
+    _sent = 0;
+    _lost = 0;
+    _namesSent = false;
+    _newChunk(0);
+    _running = true;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Stop recording
+
+ The chunks are kept for dump() and stream().  The next stream() also sends the current, partly
+ filled, chunk.
+ */
+void Trace::stop()
+{
+    core_util_critical_section_enter();
+    _running = false;
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Is recording on
+
+ @return true if recording
+ */
+bool Trace::isRunning()
+{
+    return(_running);
+}
+
+/**
+ @brief Name track
+
+ Name the span track with the given id.  The names are written with each dump.  LoopMonitor names
+ its track, which is its reporter id, when constructed.
+
+ @param id - track
+ @param name - name - truncated to TRACE_NAME_LEN characters
+ */
+void Trace::nameTrack(byte id, const char* name)
+{
+    core_util_critical_section_enter();
+    byte i = 0;
+    while (i < _nameCount && _names[i].id != id)
+    {
+        i++;
+    }
+    if (i < TRACE_MAX_NAMES)
+    {
+        _names[i].id = id;
+        memset(_names[i].name, 0, TRACE_NAME_LEN);
+        memcpy(_names[i].name, name, strnlen(name, TRACE_NAME_LEN));
+        if (i == _nameCount)
+        {
+            _nameCount++;
+        }
+    }
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Record handled report
+
+ @param rdp - pointer to report with all four times set
+
+ @note called by Reporter::markHandled()
+ */
+void Trace::report(const report_t* rdp)
+{
+    if (!_running)
+    {
+        return;
+    }
+    traceRecord_t record;
+    record.kind = TRACE_REPORT;
+    record.eventType = rdp->repType;
+    record.reporterType = rdp->source->getType();
+    record.id = rdp->source->getId();
+    record.info = rdp->info;
+    record.time[0] = rdp->timeStampEvent;
+    record.time[1] = rdp->timeStampIn;
+    record.time[2] = rdp->timeStampOut;
+    record.time[3] = rdp->timeStampDone;
+    _put(&record);
+}
+
+/**
+ @brief Record dropped report
+
+ @param type - type of report dropped
+ @param rp - reporter
+
+ @note called by Reporter::queueReport() - callable from ISR
+ */
+void Trace::drop(EventType type, Reporter* rp)
+{
+    if (!_running)
+    {
+        return;
+    }
+    traceRecord_t record;
+    memset(&record, 0, sizeof(record));
+    record.kind = TRACE_DROP;
+    record.eventType = type;
+    record.reporterType = rp->getType();
+    record.id = rp->getId();
+    record.time[0] = micros();
+    _put(&record);
+}
+
+/**
+ @brief Record span
+
+ Record activity of a thread, e.g. a loop iteration.
+
+ @param id - track
+ @param start - start time - micros()
+ @param end - end time - micros()
+
+ @note callable from ISR
+ */
+void Trace::span(byte id, unsigned long start, unsigned long end)
+{
+    if (!_running)
+    {
+        return;
+    }
+    traceRecord_t record;
+    memset(&record, 0, sizeof(record));
+    record.kind = TRACE_SPAN;
+    record.id = id;
+    record.time[0] = start;
+    record.time[1] = end;
+    _put(&record);
+}
+
+/**
+ @brief Dump trace
+
+ Write the track names and the chunks held, oldest first, as described in dawsTraceFormat.h.
+ Recording may continue.
+
+ @param out - where to write, e.g. Serial
+
+ @return number of chunks written - less than held if recording overwrote any while writing
+ */
+uint32_t Trace::dump(Print& out)
+{
+    uint32_t count = 0;
+    core_util_critical_section_enter();
+    uint32_t last = _seq;
+    uint32_t first = (last >= TRACE_CHUNKS) ? last - TRACE_CHUNKS + 1 : 0;
+    core_util_critical_section_exit();
+    _writeHeader(out);
+    for (uint32_t seq = first; seq <= last; seq++)
+    {
+        if (_writeChunk(out, seq))
+        {
+            count++;
+        }
+    }
+    return(count);
+}
+
+/**
+ @brief Stream trace
+
+ Write the chunks filled since the last call.  The track names are written first in each session.
+ Call periodically from a low priority thread, often enough that chunks are not overwritten before they
+ are sent.  Once recording has stopped the current chunk is sent too, if it holds any records.
+
+ @param out - where to write, e.g. Serial
+
+ @return number of chunks written
+ */
+uint32_t Trace::stream(Print& out)
+{
+    uint32_t count = 0;
+    if (!_namesSent)
+    {
+        _writeHeader(out);
+        _namesSent = true;
+    }
+    while (true)
+    {
+        core_util_critical_section_enter();
+        uint32_t seq = _sent;
+        bool ready = (seq < _seq)
+                     || (seq == _seq && !_running && _chunks[seq % TRACE_CHUNKS].header.count > 0);   // closed by stop()
+        if (ready)
+        {
+            _sent++;
+        }
+        core_util_critical_section_exit();
+        if (!ready)
+        {
+            return(count);
+        }
+        if (_writeChunk(out, seq))
+        {
+            count++;
+        }
+    }
+}
+
+/**
+ @brief Get lost count
+
+ @return number of records overwritten before being streamed this session
+ */
+uint32_t Trace::getLost()
+{
+    return(_lost);
+}
+
+/*********************************
+ _put
+ *********************************
+
+ Encode a record into the current chunk, starting the next chunk if
+ there may not be room.  Nothing is recorded if recording stopped
+ after the caller checked, as the current chunk may have been sent.
+
+ parameters  - pointer to record
+
+ returns none
+ *********************************/
+void Trace::_put(const traceRecord_t* rp)
+{
+    core_util_critical_section_enter();
+    if (!_running)
+    {
+        core_util_critical_section_exit();
+        return;
+    }
+    traceChunk_t* cp = &_chunks[_seq % TRACE_CHUNKS];
+    if (sizeof(cp->data) - cp->header.bytes < TRACE_MAX_ENCODED)
+    {
+        _newChunk(_seq + 1);
+        cp = &_chunks[_seq % TRACE_CHUNKS];
+    }
+    uint8_t* end = traceEncode(&_codec, rp, cp->data + cp->header.bytes);
+    cp->header.bytes = end - cp->data;
+    cp->header.count++;
+    core_util_critical_section_exit();
+}
+
+/*********************************
+ _newChunk
+ *********************************
+
+ Start a chunk overwriting the oldest if all are in use.  The records
+ in it are lost if it has not been streamed.  Called in a critical
+ section.
+
+ parameters  - sequence number
+
+ returns none
+ *********************************/
+void Trace::_newChunk(uint32_t seq)
+{
+    traceChunk_t* cp = &_chunks[seq % TRACE_CHUNKS];
+    if (seq >= TRACE_CHUNKS && seq - TRACE_CHUNKS >= _sent)
+    {
+        _lost += cp->header.count;
+        _sent = seq - TRACE_CHUNKS + 1;
+    }
+    _seq = seq;
+    memcpy(cp->header.sync, TRACE_CHUNK_SYNC, sizeof(cp->header.sync));
+    cp->header.bytes = 0;
+    cp->header.count = 0;
+    cp->header.seq = seq;
+    cp->header.session = _session;
+    cp->header.baseTime = _codec.time;
+    cp->header.check = 0;
+    cp->header.reserved = 0;
+    traceCodecReset(&_codec, cp->header.baseTime);
+}
+
+/*********************************
+ _writeHeader
+ *********************************
+
+ Write the dump header and track names.
+
+ parameters  - where to write
+
+ returns none
+ *********************************/
+void Trace::_writeHeader(Print& out)
+{
+    traceDumpHeader_t header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.reserved = 0;
+    header.chunkSize = TRACE_CHUNK_SIZE;
+    header.nameCount = _nameCount;
+    header.lost = _lost;
+    header.session = _session;
+    out.write((const uint8_t*)&header, sizeof(header));
+    out.write((const uint8_t*)_names, _nameCount * sizeof(traceName_t));
+}
+
+/*********************************
+ _writeChunk
+ *********************************
+
+ Write a chunk with its check value.  The chunk is copied so
+ recording may continue.  Nothing is written if it has been
+ overwritten.
+
+ parameters  - where to write, sequence number
+
+ returns true if written
+ *********************************/
+bool Trace::_writeChunk(Print& out, uint32_t seq)
+{
+    traceChunk_t chunk;
+    core_util_critical_section_enter();
+    const traceChunk_t* cp = &_chunks[seq % TRACE_CHUNKS];
+    memcpy(&chunk.header, &cp->header, sizeof(chunk.header));
+    memcpy(chunk.data, cp->data, cp->header.bytes);
+    core_util_critical_section_exit();
+    if (chunk.header.seq != seq)
+    {
+        return(false);
+    }
+    chunk.header.check = traceCheck(chunk.data, chunk.header.bytes);
+    out.write((const uint8_t*)&chunk, sizeof(chunk.header) + chunk.header.bytes);
+    return(true);
+}
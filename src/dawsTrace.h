@@ -0,0 +1,99 @@
+//
+/**
+ @file dawsTrace.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.b  Compressed chunks and streaming
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsTrace__
+#define ____dawsTrace__
+
+#include "dawsTraceFormat.h"
+
+#define TRACE_CHUNK_SIZE 512    ///< chunk size in bytes including header
+#define TRACE_CHUNKS 12         ///< number of chunks held
+#define TRACE_MAX_NAMES 16      ///< maximum number of named tracks
+
+/**
+ @brief Trace chunk
+
+ Encoded records as described in dawsTraceFormat.h.
+ */
+typedef struct
+{
+    traceChunkHeader_t header;                                      ///< header - check is set when written out
+    uint8_t data[TRACE_CHUNK_SIZE - sizeof(traceChunkHeader_t)];    ///< encoded records
+} traceChunk_t;
+
+/**
+ @brief Trace recorder
+
+ Records handled reports with their event, enqueue, dequeue and handled times, reports
+ dropped because the queue was full and thread activity spans (e.g. each LoopMonitor iteration).
+
+ Records are compressed as they are recorded into fixed size chunks, each independently decodable
+ (dawsTraceFormat.h).  A report typically takes 6 to 10 bytes.  When all chunks are full the oldest is
+ overwritten so the chunks hold the latest history.
+
+ Recording is off until start() is called.  Reporter::markHandled(), Reporter::queueReport() and
+ LoopMonitor::end() record when it is on.
+
+ dump() writes the chunks held for the host tools, e.g. extras/tools/dawsTraceExport.cpp which converts
+ them to Chrome trace format.  Alternatively a low priority thread may call stream() periodically to send each
+ chunk once it is full, so the whole session is captured.  After stop() the next stream() also sends the
+ last, partly filled, chunk.
+
+ @note This is a static class.
+ */
+class Trace
+{
+public:
+    static void start();
+    static void stop();
+    static bool isRunning();
+    static void nameTrack(byte, const char*);
+
+    static void report(const report_t*);
+    static void drop(EventType, Reporter*);
+    static void span(byte, unsigned long, unsigned long);
+
+    static uint32_t dump(Print&);
+    static uint32_t stream(Print&);
+    static uint32_t getLost();
+
+private:
+    static traceChunk_t _chunks[TRACE_CHUNKS];      // chunks - seq modulo TRACE_CHUNKS
+    static traceCodec_t _codec;                     // encoder state for current chunk
+    static traceName_t _names[TRACE_MAX_NAMES];     // track names
+    static byte _nameCount;                         // number of track names
+    static uint32_t _seq;                           // current chunk sequence number
+    static uint32_t _sent;                          // next chunk to stream
+    static uint32_t _session;                       // session - time of start
+    static uint32_t _lost;                          // records overwritten before sent
+    static bool _namesSent;                         // names streamed this session
+    static volatile bool _running;                  // recording
+    static void _put(const traceRecord_t*);         // encode record
+    static void _newChunk(uint32_t);                // start chunk
+    static void _writeHeader(Print&);               // write dump header and names
+    static bool _writeChunk(Print&, uint32_t);      // write chunk
+};
+
+#endif /* defined(____dawsTrace__) */
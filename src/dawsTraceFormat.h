@@ -0,0 +1,443 @@
+//
+/**
+ @file dawsTraceFormat.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.b  Chunked compressed encoding
+
+ @brief Trace record layout and encoding
+
+ The records of the trace recorder (dawsTrace.h), their compressed encoding and the binary dump.
+ Used by the host tools in extras/tools so it must only use standard headers.  All values are
+ little endian.
+
+ Records are encoded into chunks.  Each chunk is a traceChunkHeader_t followed by bytes of
+ encoded records.  The encoder state is reset at the start of each chunk so each may be decoded
+ on its own.  Each encoded record is
+
+ - tag byte: bits 0-1 kind (0 report, 1 drop, 2 span), bit 2 set if the source (kind, reporter
+   type, reporter id and event type) is the same as the previous record, bits 3-7 info dictionary
+   index or TRACE_INFO_LITERAL
+ - if not the same source: reporter type byte, reporter id varint and event type varint (spans:
+   track id varint only)
+ - record time (report handled, drop or span end) as the zigzag varint of the difference between
+   this and the previous record's time difference (delta of delta)
+ - report: handler, queue wait and event to queue times as varints.  Span: duration varint.
+ - report or drop: the info as a zigzag varint if not in the dictionary.  The dictionary holds the
+   last TRACE_DICT_LEN distinct info values literally encoded in the chunk.
+
+ A dump is a traceDumpHeader_t followed by nameCount traceName_t and then the chunks held, oldest
+ first, up to the next dump header or the end.  A chunk overwritten while a dump is written is left
+ out.  A stream is the same with chunks sent as they are filled.  Times are micros() and wrap at 32 bits.
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.b Records encoded in independently decodable chunks
+//
+
+
+#ifndef ____dawsTraceFormat__
+#define ____dawsTraceFormat__
+
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_MAGIC "DAWSTRC"   ///< binary dump header
+#define TRACE_CHUNK_SYNC "DTCK" ///< chunk header
+#define TRACE_VERSION 2         ///< binary dump version
+#define TRACE_NAME_LEN 15       ///< maximum track name length
+#define TRACE_DICT_LEN 31       ///< info dictionary entries
+#define TRACE_INFO_LITERAL 31   ///< tag info index for a value not in the dictionary
+#define TRACE_MAX_ENCODED 32    ///< longest encoded record
+
+/**
+ @brief Trace record kinds
+ */
+enum TraceKind : uint8_t
+{
+    TRACE_REPORT = 'R',     ///< report handled - all four times
+    TRACE_DROP = 'D',       ///< report discarded as the queue was full
+    TRACE_SPAN = 'S'        ///< thread activity, e.g. a periodic loop iteration
+};
+
+/**
+ @brief Trace record
+
+ As given to and returned by the codec.
+ - TRACE_REPORT: time is event, enqueue, dequeue and handled times
+ - TRACE_DROP: time[0] is the time of the attempt, the others are 0
+ - TRACE_SPAN: time[0] is the start and time[1] the end.  id is the track.  The others are 0.
+ */
+typedef struct
+{
+    uint8_t kind;           ///< TraceKind
+    uint8_t eventType;      ///< EventType - not used for spans
+    uint8_t reporterType;   ///< ReporterType character - not used for spans
+    uint8_t id;             ///< reporter id or span track
+    int32_t info;           ///< report info
+    uint32_t time[4];       ///< times - see above
+} traceRecord_t;
+
+/**
+ @brief Chunk header
+ */
+typedef struct
+{
+    char sync[4];           ///< TRACE_CHUNK_SYNC without terminator
+    uint16_t bytes;         ///< encoded bytes following
+    uint16_t count;         ///< records encoded
+    uint32_t seq;           ///< chunk sequence number from 0 at start of recording
+    uint32_t session;       ///< recording session - the time recording started
+    uint32_t baseTime;      ///< time before the first record - the previous record's time
+    uint16_t check;         ///< Fletcher-16 of the encoded bytes
+    uint16_t reserved;      ///< 0
+} traceChunkHeader_t;
+
+/**
+ @brief Track name
+
+ Names the span track with the same id, e.g. the LoopMonitor's thread.
+ */
+typedef struct
+{
+    uint8_t id;                         ///< track
+    char name[TRACE_NAME_LEN];          ///< name - nul terminated if shorter
+} traceName_t;
+
+/**
+ @brief Binary dump header
+ */
+typedef struct
+{
+    char magic[7];          ///< TRACE_MAGIC without terminator
+    uint8_t version;        ///< TRACE_VERSION
+    uint32_t reserved;      ///< 0 - the chunks following are not counted, see above
+    uint16_t chunkSize;     ///< maximum chunk size including header
+    uint16_t nameCount;     ///< number of track names
+    uint32_t lost;          ///< records overwritten before being dumped or streamed
+    uint32_t session;       ///< recording session - as chunk header
+} traceDumpHeader_t;
+
+/**
+ @brief Codec state
+
+ Reset at the start of each chunk.  The encoder and decoder keep identical state.
+ */
+typedef struct
+{
+    uint32_t time;                      ///< previous record time
+    uint32_t delta;                     ///< previous record time difference
+    uint8_t kind;                       ///< previous source
+    uint8_t eventType;
+    uint8_t reporterType;
+    uint8_t id;
+    bool any;                           ///< there is a previous record
+    uint8_t dictCount;                  ///< dictionary entries used
+    uint8_t dictNext;                   ///< next entry to replace when full
+    int32_t dict[TRACE_DICT_LEN];       ///< info dictionary
+} traceCodec_t;
+
+/**
+ @brief Reset codec
+
+ @param cp - codec
+ @param baseTime - chunk base time
+ */
+static inline void traceCodecReset(traceCodec_t* cp, uint32_t baseTime)
+{
+    memset(cp, 0, sizeof(traceCodec_t));
+    cp->time = baseTime;
+}
+
+/**
+ @brief Put varint
+
+ @param p - where to put
+ @param value - value
+
+ @return pointer after value
+ */
+static inline uint8_t* tracePutVarint(uint8_t* p, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return(p);
+}
+
+/**
+ @brief Get varint
+
+ @param p - where to get - updated
+ @param end - end of data
+
+ @return value - 0 if the data ends early
+ */
+static inline uint32_t traceGetVarint(const uint8_t** p, const uint8_t* end)
+{
+    uint32_t value = 0;
+    int shift = 0;
+    while (*p < end && shift < 35)
+    {
+        uint8_t b = *(*p)++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return(value);
+        }
+        shift += 7;
+    }
+    *p = end;
+    return(0);
+}
+
+/**
+ @brief Zigzag encode
+
+ @param value - signed value
+
+ @return value with small magnitudes small
+ */
+static inline uint32_t traceZigzag(int32_t value)
+{
+    return(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+/**
+ @brief Zigzag decode
+
+ @param value - zigzag value
+
+ @return signed value
+ */
+static inline int32_t traceUnzigzag(uint32_t value)
+{
+    return((int32_t)(value >> 1) ^ -(int32_t)(value & 1));
+}
+
+/**
+ @brief Record time
+
+ @param rp - record
+
+ @return time the record was made - report handled, drop or span end
+ */
+static inline uint32_t traceRecordTime(const traceRecord_t* rp)
+{
+    switch (rp->kind)
+    {
+    case TRACE_REPORT:
+        return(rp->time[3]);
+    case TRACE_SPAN:
+        return(rp->time[1]);
+    default:
+        return(rp->time[0]);
+    }
+}
+
+/**
+ @brief Encode record
+
+ @param cp - codec
+ @param rp - record
+ @param p - where to encode - at least TRACE_MAX_ENCODED bytes
+
+ @return pointer after encoded record
+ */
+static inline uint8_t* traceEncode(traceCodec_t* cp, const traceRecord_t* rp, uint8_t* p)
+{
+    uint8_t kind = (rp->kind == TRACE_REPORT) ? 0 : (rp->kind == TRACE_DROP) ? 1 : 2;
+    bool span = (kind == 2);
+    bool same = cp->any && cp->kind == kind && cp->id == rp->id &&
+                (span || (cp->eventType == rp->eventType && cp->reporterType == rp->reporterType));
+    uint8_t info = 0;
+    bool literal = false;
+    if (!span)
+    {
+        while (info < cp->dictCount && cp->dict[info] != rp->info)
+        {
+            info++;
+        }
+        if (info == cp->dictCount)
+        {
+            literal = true;
+            info = TRACE_INFO_LITERAL;
+        }
+    }
+    *p++ = kind | (same ? 0x04 : 0) | (info << 3);
+    if (!same)
+    {
+        if (!span)
+        {
+            *p++ = rp->reporterType;
+        }
+        p = tracePutVarint(p, rp->id);
+        if (!span)
+        {
+            p = tracePutVarint(p, rp->eventType);
+        }
+        cp->kind = kind;
+        cp->eventType = rp->eventType;
+        cp->reporterType = rp->reporterType;
+        cp->id = rp->id;
+        cp->any = true;
+    }
+    uint32_t t = traceRecordTime(rp);
+    uint32_t delta = t - cp->time;
+    p = tracePutVarint(p, traceZigzag((int32_t)(delta - cp->delta)));
+    cp->time = t;
+    cp->delta = delta;
+    if (kind == 0)
+    {
+        p = tracePutVarint(p, rp->time[3] - rp->time[2]);
+        p = tracePutVarint(p, rp->time[2] - rp->time[1]);
+        p = tracePutVarint(p, rp->time[1] - rp->time[0]);
+    }
+    else if (span)
+    {
+        p = tracePutVarint(p, rp->time[1] - rp->time[0]);
+    }
+    if (literal)
+    {
+        p = tracePutVarint(p, traceZigzag(rp->info));
+        if (cp->dictCount < TRACE_DICT_LEN)
+        {
+            cp->dict[cp->dictCount++] = rp->info;
+        }
+        else
+        {
+            cp->dict[cp->dictNext] = rp->info;
+            cp->dictNext = (cp->dictNext + 1) % TRACE_DICT_LEN;
+        }
+    }
+    return(p);
+}
+
+/**
+ @brief Decode record
+
+ @param cp - codec
+ @param p - encoded record
+ @param end - end of chunk data
+ @param rp - where the record is returned
+
+ @return pointer after the record or nullptr if the data is not valid
+ */
+static inline const uint8_t* traceDecode(traceCodec_t* cp, const uint8_t* p, const uint8_t* end,
+                                         traceRecord_t* rp)
+{
+    if (p >= end)
+    {
+        return(nullptr);
+    }
+    uint8_t tag = *p++;
+    uint8_t kind = tag & 0x03;
+    bool span = (kind == 2);
+    uint8_t info = tag >> 3;
+    if (kind == 3 || (tag & 0x04 && !cp->any) || (!span && info != TRACE_INFO_LITERAL && info >= cp->dictCount))
+    {
+        return(nullptr);
+    }
+    if ((tag & 0x04) == 0)
+    {
+        if (!span)
+        {
+            if (p >= end)
+            {
+                return(nullptr);
+            }
+            cp->reporterType = *p++;
+        }
+        else
+        {
+            cp->reporterType = 0;
+        }
+        cp->id = (uint8_t)traceGetVarint(&p, end);
+        cp->eventType = span ? 0 : (uint8_t)traceGetVarint(&p, end);
+        cp->kind = kind;
+        cp->any = true;
+    }
+    memset(rp, 0, sizeof(traceRecord_t));
+    rp->kind = (kind == 0) ? TRACE_REPORT : (kind == 1) ? TRACE_DROP : TRACE_SPAN;
+    rp->eventType = cp->eventType;
+    rp->reporterType = cp->reporterType;
+    rp->id = cp->id;
+    cp->delta += (uint32_t)traceUnzigzag(traceGetVarint(&p, end));
+    cp->time += cp->delta;
+    if (kind == 0)
+    {
+        rp->time[3] = cp->time;
+        rp->time[2] = rp->time[3] - traceGetVarint(&p, end);
+        rp->time[1] = rp->time[2] - traceGetVarint(&p, end);
+        rp->time[0] = rp->time[1] - traceGetVarint(&p, end);
+    }
+    else if (span)
+    {
+        rp->time[1] = cp->time;
+        rp->time[0] = rp->time[1] - traceGetVarint(&p, end);
+    }
+    else
+    {
+        rp->time[0] = cp->time;
+    }
+    if (!span)
+    {
+        if (info == TRACE_INFO_LITERAL)
+        {
+            rp->info = traceUnzigzag(traceGetVarint(&p, end));
+            if (cp->dictCount < TRACE_DICT_LEN)
+            {
+                cp->dict[cp->dictCount++] = rp->info;
+            }
+            else
+            {
+                cp->dict[cp->dictNext] = rp->info;
+                cp->dictNext = (cp->dictNext + 1) % TRACE_DICT_LEN;
+            }
+        }
+        else
+        {
+            rp->info = cp->dict[info];
+        }
+    }
+    return(p);
+}
+
+/**
+ @brief Fletcher-16 check
+
+ @param p - data
+ @param length - number of bytes
+
+ @return check value
+ */
+static inline uint16_t traceCheck(const uint8_t* p, uint32_t length)
+{
+    uint16_t a = 0;
+    uint16_t b = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        a = (a + p[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return((uint16_t)(b << 8 | a));
+}
+
+#endif /* defined(____dawsTraceFormat__) */
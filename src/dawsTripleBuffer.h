@@ -0,0 +1,146 @@
+//
+/**
+ @file dawsTripleBuffer.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsTripleBuffer__
+#define ____dawsTripleBuffer__
+
+/**
+ @brief Triple buffer
+
+ This hands a structure (a frame) from a single writer to a single reader, e.g. motor or
+ odometer state from the control thread to the UI at MAIN_PRIORITY.
+
+ There are three buffers.  The writer owns one, the reader owns one and the third is
+ shared.  The writer fills its buffer and publishes it by exchanging it with the shared
+ buffer.  The reader takes the newest frame by exchanging its buffer with the shared buffer.
+ Each exchange is a single atomic operation so neither side ever blocks or waits for the other, there
+ is no priority inversion and the reader never sees a partly written frame.
+
+ Frames published while the reader is not reading are overwritten.  The reader always gets the
+ newest complete frame.
+
+ The buffer the writer gets after publishing is not its last frame: it holds the frame published
+ two publishes before, or a frame the reader has finished with.  The writer must therefore set every
+ field of the frame before each publish(), not only those that changed, or the reader may see stale
+ values mixed with new ones.  Keep the writer's current state in its own variable and copy it in whole.
+
+ Typical writer usage:
+ @code
+    MotorState_t& f = buffer.getWriteBuffer();
+    f = motorState;         // the whole frame - the buffer holds an old frame
+    buffer.publish();
+ @endcode
+ or, field by field:
+ @code
+    MotorState_t& f = buffer.getWriteBuffer();
+    f.speed = speed;        // every field is set
+    f.direction = direction;
+    f.stopped = stopped;
+    buffer.publish();
+ @endcode
+
+ Typical reader usage:
+ @code
+    buffer.update();
+    const MotorState_t& f = buffer.getReadBuffer();
+ @endcode
+
+ @note There must be only one writer and one reader.
+ */
+template <typename T>
+class TripleBuffer: mbed::NonCopyable<TripleBuffer<T> >
+{
+public:
+    /**
+     @brief Construct triple buffer
+
+     Buffers are zero initialised.  The writer owns buffer 0, the reader buffer 1 and buffer 2 is shared.
+     */
+    TripleBuffer(): _buffers(), _shared(2), _writeIdx(0), _readIdx(1)
+    {
+    }
+
+    /**
+     @brief Get write buffer
+
+     @return reference to the buffer owned by the writer.  Only valid until publish() is called.  It holds an
+     old frame, so set every field before publishing.
+     */
+    T& getWriteBuffer()
+    {
+        return(_buffers[_writeIdx]);
+    }
+
+    /**
+     @brief Publish
+
+     Make the write buffer the newest frame.  The writer then owns the previously shared buffer.
+     Callable from ISR.
+     */
+    void publish()
+    {
+        uint8_t old = core_util_atomic_exchange_u8(&_shared, _writeIdx | FRESH);
+        _writeIdx = old & INDEX;
+    }
+
+    /**
+     @brief Update
+
+     Take the newest frame if one has been published since the last update.
+
+     @return true if there was a new frame
+     */
+    bool update()
+    {
+        if ((core_util_atomic_load_u8(&_shared) & FRESH) == 0)
+        {
+            return(false);
+        }
+        uint8_t old = core_util_atomic_exchange_u8(&_shared, _readIdx);
+        _readIdx = old & INDEX;
+        return(true);
+    }
+
+    /**
+     @brief Get read buffer
+
+     @return reference to the frame owned by the reader.  Only valid until update() is called.
+     */
+    const T& getReadBuffer() const
+    {
+        return(_buffers[_readIdx]);
+    }
+
+private:
+    static const uint8_t INDEX = 0x03;  ///< mask for buffer index
+    static const uint8_t FRESH = 0x04;  ///< flag - shared buffer holds a frame not yet read
+
+    T _buffers[3];              ///< the three buffers
+    volatile uint8_t _shared;   ///< index of shared buffer and fresh flag
+    uint8_t _writeIdx;          ///< index of writer's buffer
+    uint8_t _readIdx;           ///< index of reader's buffer
+};
+
+#endif /* defined(____dawsTripleBuffer__) */
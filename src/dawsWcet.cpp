@@ -0,0 +1,560 @@
+/**
+@file dawsWcet.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsLoopMonitor.h"
+#include "dawsThreadStats.h"
+#include "dawsWorkerPool.h"
+#include "dawsFlashLog.h"
+#include "dawsTelemetry.h"
+#include "dawsHeapGuard.h"
+#include "dawsWcet.h"
+
+uint32_t Wcet::_overhead = 0;
+uint32_t Wcet::_heapFailures = 0;
+
+/**
+ @brief Harness reporter
+
+ Used by the harness to make reports.  Only constructed, and added to the reporter chain,
+ if the harness is run.
+ */
+class WcetReporter: public Reporter
+{
+public:
+    WcetReporter() : Reporter(WCET_REP)
+    {
+    }
+
+    ReporterType getType()
+    {
+        return(WCET_REP);
+    }
+};
+
+/**
+ @brief Harness telemetry output
+
+ Discards what is sent so only the telemetry cycle is measured.
+ */
+class WcetSink: public Print
+{
+public:
+    size_t write(uint8_t)
+    {
+        return(1);
+    }
+
+    size_t write(const uint8_t*, size_t size)
+    {
+        return(size);
+    }
+};
+
+/*********************************
+ drain
+ *********************************
+
+ Discard all reports in the report queue.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+static void drain()
+{
+    report_t report;
+    while (Reporter::tryGetReport(&report))
+    {
+    }
+}
+
+/*********************************
+ fill
+ *********************************
+
+ Fill the report queue to a depth with critical reports, which
+ are admitted up to the queue capacity.
+
+ parameters  - reporter to make the reports, depth
+
+ returns none
+ *********************************/
+static void fill(Reporter* rp, int depth)
+{
+    for (int i = 0; i < depth; i++)
+    {
+        rp->queueReport(VL53_RANGE_CLOSE, i);
+    }
+}
+
+/*********************************
+ noWork
+ *********************************
+
+ Work item for the worker pool scenario.
+
+ parameters  - argument, not used
+
+ returns none
+ *********************************/
+static void noWork(void*)
+{
+}
+
+/**
+ @brief Initialise
+
+ Enable the tick counter and measure the measurement overhead.
+
+ @note This is a static function
+ */
+void Wcet::init()
+{
+#if defined(ARDUINO)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    _overhead = 0;
+    wcet_t empty;
+    reset(&empty);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        uint32_t start = now();
+        record(&empty, now() - start);
+    }
+    _overhead = empty.min;
+}
+
+/**
+ @brief Reset statistics
+
+ @param sp - pointer to statistics
+
+ @note This is a static function
+ */
+void Wcet::reset(wcet_t* sp)
+{
+    sp->count = 0;
+    sp->min = ~0U;
+    sp->max = 0;
+    sp->total = 0;
+    sp->heap = HeapGuard::getCount();
+}
+
+/**
+ @brief Record measurement
+
+ @param sp - pointer to statistics
+ @param ticks - measured time in ticks.  The measurement overhead is subtracted.
+
+ @note This is a static function
+ */
+void Wcet::record(wcet_t* sp, uint32_t ticks)
+{
+    ticks = (ticks > _overhead) ? ticks - _overhead : 0;
+    sp->count++;
+    sp->total += ticks;
+    if (ticks < sp->min)
+    {
+        sp->min = ticks;
+    }
+    if (ticks > sp->max)
+    {
+        sp->max = ticks;
+    }
+}
+
+/**
+ @brief Print statistics
+
+ Print a CSV line - wcet,name,count,min,avg,max,tick
+
+ If there have been heap allocations since the statistics were reset print heap,name,allocations as
+ well and count the scenario as a failure.
+
+ @param out - where to print, e.g. Serial
+ @param name - scenario name
+ @param sp - pointer to statistics
+
+ @note This is a static function
+ */
+void Wcet::print(Print& out, const char* name, const wcet_t* sp)
+{
+    out.print("wcet,");
+    out.print(name);
+    out.print(',');
+    out.print((unsigned long)sp->count);
+    out.print(',');
+    out.print((unsigned long)(sp->count == 0 ? 0 : sp->min));
+    out.print(',');
+    out.print((unsigned long)(sp->count == 0 ? 0 : sp->total / sp->count));
+    out.print(',');
+    out.print((unsigned long)sp->max);
+    out.print(',');
+    out.println(getTickName());
+    uint32_t allocations = HeapGuard::getCount() - sp->heap;
+    if (allocations != 0)
+    {
+        out.print("heap,");
+        out.print(name);
+        out.print(',');
+        out.println((unsigned long)allocations);
+        _heapFailures++;
+    }
+}
+
+/**
+ @brief Get tick name
+
+ @return units of ticks - "cycles" on target, "ns" on host
+
+ @note This is a static function
+ */
+const char* Wcet::getTickName()
+{
+#if defined(ARDUINO)
+    return("cycles");
+#else
+    return("ns");
+#endif
+}
+
+/**
+ @brief Run harness
+
+ Run all the scenarios and print the results.
+
+ @param out - where to print the results, e.g. Serial
+ @param contention - backend function to start and stop contending load.  May be nullptr.
+
+ @return number of scenarios that allocated from the heap - always 0 if HEAP_GUARD is false or
+ HeapGuard::initComplete() has not been called
+
+ @note This is a static function
+ */
+uint32_t Wcet::runHarness(Print& out, contention_t contention)
+{
+    static WcetReporter reporter;
+    static LoopMonitor monitor("wcet", 1000, 1000, false);
+    static WcetSink sink;
+    WcetReporter* rp = &reporter;
+    report_t report;
+    latest_t latest;
+    wcet_t stat;
+    uint32_t start;
+    uint32_t ticks;
+
+    init();
+    drain();
+    _heapFailures = 0;
+
+    // queueReport with an empty queue
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(SET_AUTO, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+        drain();
+    }
+    print(out, "queueReport", &stat);
+
+    // queueReport with the queue full - the overflow path
+    fill(rp, REPORT_QUEUE_LEN);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(VL53_RANGE_CLOSE, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    drain();
+    print(out, "queueReport full", &stat);
+
+    // queueReport shed as the queue is at the limit for its class
+    fill(rp, REPORT_LIMIT_NORMAL);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(SET_AUTO, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    drain();
+    print(out, "queueReport shed normal", &stat);
+    fill(rp, REPORT_LIMIT_LOW);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(BLE_PEER_FOUND, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    drain();
+    print(out, "queueReport shed low", &stat);
+
+    // tryGetReport with a report waiting
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        rp->queueReport(SET_AUTO, i);
+        start = now();
+        Reporter::tryGetReport(&report);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "tryGetReport", &stat);
+
+    // tryGetReport with the queue empty
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        Reporter::tryGetReport(&report);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "tryGetReport empty", &stat);
+
+    // report dispatch completion
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        rp->queueReport(SET_AUTO, i);
+        Reporter::tryGetReport(&report);
+        start = now();
+        Reporter::markHandled(&report);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "markHandled", &stat);
+
+    // queue kept nearly full so its indices and free list wrap round many times
+    wcet_t statGet;
+    reset(&stat);
+    reset(&statGet);
+    fill(rp, REPORT_QUEUE_LEN - 1);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(VL53_RANGE_CLOSE, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+        start = now();
+        Reporter::tryGetReport(&report);
+        ticks = now() - start;
+        record(&statGet, ticks);
+    }
+    drain();
+    print(out, "queueReport wrap", &stat);
+    print(out, "tryGetReport wrap", &statGet);
+
+    // latest value cell
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->publishLatest(i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "publishLatest", &stat);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->getLatest(&latest);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "getLatest", &stat);
+
+    // periodic loop timing
+    monitor.resetStats();
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        monitor.begin();
+        monitor.end();
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "LoopMonitor", &stat);
+
+    // thread sampling as the Ticker does it - if this thread is not registered each sample searches
+    // all registered threads, the worst case
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        ThreadStats::sample();
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "ThreadStats::sample", &stat);
+
+    // binary log - the ring is emptied every so often so both the write and the drop are measured
+    logRecord_t logRecord;
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        if (i % (LOG_RING_LEN * 2) == 0)
+        {
+            while (Log::read(&logRecord))
+            {
+            }
+        }
+        start = now();
+        Log::write(LOG_TEXT2, i, -i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    while (Log::read(&logRecord))
+    {
+    }
+    print(out, "Log::write", &stat);
+
+    // persistent log staging - dropped once the staging buffer is full, or if FlashLog has not begun
+    logRecord.format = LOG_TEXT2;
+    logRecord.argc = 2;
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        logRecord.timeStamp = micros();
+        logRecord.args[0] = i;
+        logRecord.args[1] = -i;
+        start = now();
+        FlashLog::append(&logRecord);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "FlashLog::append", &stat);
+
+    // worker pool - work submitted then dispatched in this thread.  If the pool is started its
+    // thread may dispatch some items first.
+    wcet_t statDispatch;
+    WorkerPool::dispatch(WORK_NORMAL);  // the pool is made on first use - not timed
+    reset(&stat);
+    reset(&statDispatch);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        WorkerPool::submit(WORK_NORMAL, noWork, nullptr);
+        ticks = now() - start;
+        record(&stat, ticks);
+        start = now();
+        WorkerPool::dispatch(WORK_NORMAL);
+        ticks = now() - start;
+        record(&statDispatch, ticks);
+    }
+    print(out, "WorkerPool::submit", &stat);
+    print(out, "WorkerPool::dispatch", &statDispatch);
+
+    // telemetry cycle to an output that discards it
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        Telemetry::send(sink);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "Telemetry::send", &stat);
+
+    // control loop macros - extreme values so any data dependent timing shows
+    static const long values[] = {0, 1, -1, 0x7FFFFF00L, -0x7FFFFF00L, 0x55555555L, -0x55555555L};
+    const int nValues = sizeof(values) / sizeof(values[0]);
+    volatile long x;
+    volatile long y = 0;
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        x = values[i % nValues];
+        start = now();
+        y = ROUND(x, 8);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "ROUND", &stat);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        x = values[i % nValues];
+        start = now();
+        y = LP_FILTER(x, y, 3);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "LP_FILTER", &stat);
+
+    if (contention == nullptr)
+    {
+        return(_heapFailures);
+    }
+
+    // under contention from other producers and the consumer
+    contention(rp, true);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->queueReport(SET_AUTO, i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "queueReport contended", &stat);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->publishLatest(i);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "publishLatest contended", &stat);
+    reset(&stat);
+    for (int i = 0; i < WCET_ITERATIONS; i++)
+    {
+        start = now();
+        rp->getLatest(&latest);
+        ticks = now() - start;
+        record(&stat, ticks);
+    }
+    print(out, "getLatest contended", &stat);
+    contention(rp, false);
+    drain();
+    return(_heapFailures);
+}
@@ -0,0 +1,119 @@
+//
+/**
+ @file dawsWcet.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsWcet__
+#define ____dawsWcet__
+
+#ifndef WCET_ITERATIONS
+#define WCET_ITERATIONS 1000    ///< number of measurements per harness scenario
+#endif
+
+/**
+ @brief Execution time statistics
+
+ Times are in ticks - CPU cycles on target, nanoseconds on host.
+ */
+typedef struct
+{
+    uint32_t count; ///< number of measurements
+    uint32_t min;   ///< minimum
+    uint32_t max;   ///< maximum
+    uint64_t total; ///< total - for average
+    uint32_t heap;  ///< heap guard allocation count at reset
+} wcet_t;
+
+/**
+ @brief Contention control
+
+ Supplied by the harness backend.  Called with true to start load that contends with the
+ function being measured (e.g. other threads and ISRs using the report queue and publishing
+ the harness reporter's latest value) and false to stop it.  The load must include a consumer
+ so the queue does not stay full.  The first parameter is the harness reporter.
+ */
+typedef void (*contention_t)(Reporter*, bool);
+
+/**
+ @brief Worst case execution time measurement
+
+ This measures the execution time of the library's hot functions (queueReport, which is callable
+ from ISRs, tryGetReport, the latest value cell and the ROUND and LP_FILTER macros used in control loops)
+ under adversarial conditions - full queue, reports shed by class, contention and queue index wrap-around.
+
+ On target the tick is the Cortex-M DWT cycle counter.  On host (ARDUINO not defined) it is the steady
+ clock in nanoseconds.  The host backend is in extras/wcet and the target backend is the wcetHarness example.
+
+ Results are printed as CSV lines:
+
+     wcet,<scenario>,<count>,<min>,<avg>,<max>,<tick>
+
+ Measurement overhead, as found by timing an empty region, is subtracted.
+
+ The report dispatch (markHandled), periodic loop (LoopMonitor), thread sampling (ThreadStats::sample),
+ worker pool submit and dispatch, persistent log append and telemetry send paths are measured too.
+
+ If HEAP_GUARD is true the heap guard allocation count is compared before and after each scenario.
+ A scenario that allocates from the heap also prints
+
+     heap,<scenario>,<allocations>
+
+ and is counted as a failure.  Allocations are only counted once the application, or the harness backend,
+ has called HeapGuard::initComplete(), so call it before running the harness.
+
+ @note Run the harness before the application's reporters start.  It uses the report queue and
+ discards any reports in it.
+
+ @note This is a static class.
+ */
+class Wcet
+{
+public:
+    static void init();
+    static void reset(wcet_t*);
+    static void record(wcet_t*, uint32_t);
+    static void print(Print&, const char*, const wcet_t*);
+    static uint32_t runHarness(Print&, contention_t);
+    static const char* getTickName();
+
+    /**
+     @brief Get tick count
+
+     @return current tick count - wraps
+     */
+    static inline uint32_t now()
+    {
+#if defined(ARDUINO)
+        return(DWT->CYCCNT);
+#else
+        return((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+private:
+    static uint32_t _overhead;  // measurement overhead in ticks
+    static uint32_t _heapFailures;  // scenarios that allocated from the heap
+};
+
+#endif /* defined(____dawsWcet__) */
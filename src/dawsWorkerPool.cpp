@@ -0,0 +1,333 @@
+/**
+@file dawsWorkerPool.cpp
+@author Paul Redhead
+@copyright (C) 2021 Paul Redhead
+@version 0.a
+ */
+//
+//
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+//  Version 0.a First released version
+//
+#include <Arduino.h>
+#include <mbed.h>
+#include <daws.h>
+#include <new>
+#include "dawsReporter.h"
+#include "dawsLog.h"
+#include "dawsPriority.h"
+#include "dawsThreadStats.h"
+#include "dawsWorkerPool.h"
+
+/**
+ @brief Subsystem for each class
+
+ The class's thread runs at this subsystem's configured priority.
+ */
+static const Subsystem_t workSubsystems[WORK_CLASSES] = {SUB_MOTOR, SUB_PN532, SUB_BLE};
+
+/**
+ @brief Worker thread stacks
+
+ Statically allocated so the threads do not take their stacks from the heap.
+ */
+MBED_ALIGN(8) static unsigned char workStacks[WORK_CLASSES][WORK_STACK_SIZE];
+
+/**
+ @brief Worker thread names and initial priorities
+ */
+static const char* const workNames[WORK_CLASSES] = {"workHigh", "workAboveNormal", "workNormal"};
+static const osPriority_t workPriorities[WORK_CLASSES] = {MOTOR_PRIORITY, PN532_PRIORITY, BLE_PRIORITY};
+
+#define POOL_NONE 0         ///< queues and threads not made
+#define POOL_MAKING 1       ///< queues and threads being made
+#define POOL_READY 2        ///< queues and threads made
+
+/**
+ @brief Work queue and thread storage
+
+ The rtos::Mail queues and rtos::Threads are constructed here by _make() rather than as static objects,
+ as their constructors are not constant, so the pool does not depend on the order of static initialisation.
+ */
+MBED_ALIGN(8) static unsigned char queueStorage[WORK_CLASSES][sizeof(rtos::Mail<work_t, WORK_QUEUE_LEN>)];
+MBED_ALIGN(8) static unsigned char threadStorage[WORK_CLASSES][sizeof(rtos::Thread)];
+
+DAWS_CONSTINIT rtos::Mail<work_t, WORK_QUEUE_LEN>* WorkerPool::_queues[WORK_CLASSES] = {};
+DAWS_CONSTINIT rtos::Thread* WorkerPool::_threads[WORK_CLASSES] = {};
+DAWS_CONSTINIT volatile uint8_t WorkerPool::_state = POOL_NONE;
+DAWS_CONSTINIT workStats_t WorkerPool::_stats[WORK_CLASSES] = {};
+DAWS_CONSTINIT uint32_t WorkerPool::_clientStack = 0;
+DAWS_CONSTINIT uint16_t WorkerPool::_clientCount = 0;
+
+/**
+ @brief Start worker pool
+
+ Start the worker threads at the priorities configured for the WORK_HIGH, WORK_ABOVE_NORMAL and
+ WORK_NORMAL subsystems (MOTOR, PN532 and BLE).  The threads are registered for CPU time and stack
+ accounting.  Statistics are reset.
+
+ @note This is a static function
+ */
+void WorkerPool::start()
+{
+    _make();
+    resetStats();
+    for (int i = 0; i < WORK_CLASSES; i++)
+    {
+        _threads[i]->start(mbed::callback(_run, _queues[i]));
+        _threads[i]->set_priority(Priority::get(workSubsystems[i]));
+        ThreadStats::registerThread(_threads[i]->get_id(), nullptr);
+    }
+}
+
+/**
+ @brief Submit work
+
+ Queue a work item to be run by the worker thread for the given priority class.
+
+ @param cls - priority class
+ @param fn - function to be run
+ @param arg - argument to be passed to the function
+
+ @return true if queued.  False if the class is not valid or its queue is full, or if called from ISR before
+ the pool is made by start() or a call from a thread.
+
+ @note this is callable from ISR and therefore should not include DEBUG prints.
+ @note This is a static function
+ */
+bool WorkerPool::submit(WorkClass_t cls, workFn_t fn, void* arg)
+{
+    if (cls >= WORK_CLASSES)
+    {
+        return(false);
+    }
+    if (core_util_atomic_load_u8(&_state) != POOL_READY)
+    {
+        if (core_util_is_isr_active())
+        {
+            core_util_atomic_incr_u32(&_stats[cls].dropped, 1);
+            return(false);  // cannot construct the queues in an ISR
+        }
+        _make();
+    }
+    work_t* wp = _queues[cls]->try_alloc();
+    if (wp == nullptr)
+    {
+        core_util_atomic_incr_u32(&_stats[cls].dropped, 1);
+        Log::write(LOG_WORK_FULL, cls);
+        return(false);
+    }
+    wp->fn = fn;
+    wp->arg = arg;
+    wp->timeStamp = micros();
+    _queues[cls]->put(wp);
+    return(true);
+}
+
+/**
+ @brief Declare client
+
+ A device using the pool declares the stack size its own thread would have needed.  This is
+ used to calculate the RAM saved by the pool.
+
+ @param stackSize - stack size in bytes
+
+ @note This is a static function
+ */
+void WorkerPool::declareClient(uint32_t stackSize)
+{
+    _clientStack += stackSize;
+    _clientCount++;
+}
+
+/**
+ @brief Get RAM saved
+
+ The RAM the declared clients would have used for their own threads and stacks less the RAM
+ used by the pool's threads, stacks and queues.
+
+ @return RAM saved in bytes.  Negative if the pool uses more than it saves.
+
+ @note This is a static function
+ */
+int32_t WorkerPool::getRamSaved()
+{
+    int32_t clients = _clientStack + _clientCount * sizeof(rtos::Thread);
+    int32_t pool = sizeof(workStacks) + sizeof(threadStorage) + sizeof(queueStorage);
+    return(clients - pool);
+}
+
+/**
+ @brief Get statistics
+
+ @param cls - priority class
+ @param sp - pointer to where the statistics are to be copied.  All zero if the class is not valid.
+
+ @note This is a static function
+ */
+void WorkerPool::getStats(WorkClass_t cls, workStats_t* sp)
+{
+    if (cls >= WORK_CLASSES)
+    {
+        memset(sp, 0, sizeof(workStats_t));
+        return;
+    }
+    core_util_critical_section_enter();
+    *sp = _stats[cls];
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Reset statistics
+
+ @note This is a static function
+ */
+void WorkerPool::resetStats()
+{
+    core_util_critical_section_enter();
+    for (int i = 0; i < WORK_CLASSES; i++)
+    {
+        _stats[i].count = 0;
+        _stats[i].dropped = 0;
+        _stats[i].minLatency = ~0UL;
+        _stats[i].maxLatency = 0;
+        _stats[i].totalLatency = 0;
+    }
+    core_util_critical_section_exit();
+}
+
+/**
+ @brief Dispatch work
+
+ Run one work item from a class's queue, if there is one, in the caller's thread.  The worker threads
+ wait for work and dispatch it.  The application, e.g. a test, may also call this whether or not the
+ pool is started.
+
+ @param cls - priority class
+
+ @return true if a work item was run.  False if the class is not valid or its queue was empty.
+
+ @note Not callable from ISR.
+ @note This is a static function
+ */
+bool WorkerPool::dispatch(WorkClass_t cls)
+{
+    if (cls >= WORK_CLASSES)
+    {
+        return(false);
+    }
+    _make();
+    work_t* wp = _queues[cls]->try_get();
+    if (wp == nullptr)
+    {
+        return(false);
+    }
+    _dispatch(cls, wp);
+    return(true);
+}
+
+/*********************************
+ _dispatch
+ *********************************
+
+ Free a work item taken from a class's queue, record the dispatch latency
+ and run it.
+
+ parameters  - priority class, work item
+
+ returns none
+ *********************************/
+void WorkerPool::_dispatch(WorkClass_t cls, work_t* wp)
+{
+    workStats_t* sp = &_stats[cls];
+    work_t work = *wp;
+    _queues[cls]->free(wp);
+    unsigned long latency = micros() - work.timeStamp;
+    core_util_critical_section_enter();
+    sp->count++;
+    sp->totalLatency += latency;
+    if (latency < sp->minLatency)
+    {
+        sp->minLatency = latency;
+    }
+    if (latency > sp->maxLatency)
+    {
+        sp->maxLatency = latency;
+    }
+    core_util_critical_section_exit();
+    work.fn(work.arg);
+}
+
+/*********************************
+ _run
+ *********************************
+
+ Worker thread.  Wait for work items on the class's queue and dispatch
+ them in turn.
+
+ parameters  - pointer to the class's work queue
+
+ returns never
+ *********************************/
+void WorkerPool::_run(rtos::Mail<work_t, WORK_QUEUE_LEN>* queue)
+{
+    byte cls = 0;
+    while (_queues[cls] != queue)
+    {
+        cls++;
+    }
+    while (true)
+    {
+        work_t* wp = queue->try_get_for(rtos::Kernel::wait_for_u32_forever);
+        if (wp != nullptr)
+        {
+            _dispatch((WorkClass_t)cls, wp);
+        }
+    }
+}
+
+/*********************************
+ _make
+ *********************************
+
+ Construct the work queues and worker threads in their static storage
+ if not already made.  The first caller to claim them constructs them;
+ any other caller meanwhile sleeps until they are ready, so a lower
+ priority thread constructing them is not starved.  Not called from ISR.
+
+ parameters  - none
+
+ returns none
+ *********************************/
+void WorkerPool::_make()
+{
+    uint8_t state = POOL_NONE;
+    if (core_util_atomic_cas_u8(&_state, &state, POOL_MAKING))
+    {
+        for (int i = 0; i < WORK_CLASSES; i++)
+        {
+            _queues[i] = new (queueStorage[i]) rtos::Mail<work_t, WORK_QUEUE_LEN>();
+            _threads[i] = new (threadStorage[i]) rtos::Thread(workPriorities[i], WORK_STACK_SIZE, workStacks[i],
+                                                              workNames[i]);
+        }
+        core_util_atomic_store_u8(&_state, POOL_READY);
+    }
+    while (core_util_atomic_load_u8(&_state) != POOL_READY)
+    {
+        rtos::ThisThread::sleep_for(rtos::Kernel::Clock::duration_u32(1));
+    }
+}
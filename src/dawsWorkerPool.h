@@ -0,0 +1,122 @@
+//
+/**
+ @file dawsWorkerPool.h
+ @author Paul Redhead
+ @copyright (C) 2021 Paul Redhead
+ @version 0.a  Initial release
+ */
+
+//
+//  This file is part of DAWS.
+//  DAWS is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  DAWS is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with DAWS.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef ____dawsWorkerPool__
+#define ____dawsWorkerPool__
+
+#ifndef WORK_STACK_SIZE
+#define WORK_STACK_SIZE 2048    ///< stack size of each worker thread
+#endif
+#ifndef WORK_QUEUE_LEN
+#define WORK_QUEUE_LEN 8        ///< capacity of the work queue for each priority class
+#endif
+
+/**
+ @brief Work priority class
+
+ Each class has one worker thread.
+ */
+enum WorkClass_t : byte
+{
+    WORK_HIGH,          ///< SUB_MOTOR priority - motor, odometer and point work
+    WORK_ABOVE_NORMAL,  ///< SUB_PN532 priority - automaton, NFC and VL53 work
+    WORK_NORMAL,        ///< SUB_BLE priority - BLE work
+    WORK_CLASSES        ///< number of classes - must be last
+};
+
+/**
+ @brief Work function type
+
+ The parameter is the argument given when the work was submitted.
+ */
+typedef void (*workFn_t)(void*);
+
+/**
+ @brief Work item
+ */
+typedef struct
+{
+    workFn_t fn;                ///< function to be run
+    void* arg;                  ///< its argument
+    unsigned long timeStamp;    ///< time submitted
+} work_t;
+
+/**
+ @brief Work class statistics
+
+ Dispatch latency is the time from submission until the work function is called.
+ */
+typedef struct
+{
+    uint32_t count;             ///< number of work items run
+    uint32_t dropped;           ///< number of submissions refused as queue full
+    unsigned long minLatency;   ///< minimum dispatch latency (us)
+    unsigned long maxLatency;   ///< maximum dispatch latency (us)
+    uint64_t totalLatency;      ///< total dispatch latency (us) - for average
+} workStats_t;
+
+/**
+ @brief Prioritised worker pool
+
+ Rather than each device manager having its own thread, and stack, devices submit work items
+ to a priority class.  Each class has a single worker thread running its work items in turn.  Many devices
+ then share a few stacks.
+
+ Work items are queued by value in an rtos Mail queue so work may be submitted from an ISR, e.g. a Ticker
+ driving a periodic sample.
+
+ The queues and threads are constructed in static storage by start(), or by the first submit() or dispatch()
+ from a thread, so the pool does not depend on the order of static initialisation.
+
+ @note Work items of the same class are run one at a time.  A work item should not wait for long
+ or other devices in the class will be delayed.  Use the dispatch latency statistics to check.
+
+ @note This is a static class.
+ */
+class WorkerPool
+{
+public:
+    static void start();
+    static bool submit(WorkClass_t, workFn_t, void*);
+    static bool dispatch(WorkClass_t);
+    static void declareClient(uint32_t);
+    static int32_t getRamSaved();
+    static void getStats(WorkClass_t, workStats_t*);
+    static void resetStats();
+
+private:
+    static rtos::Mail<work_t, WORK_QUEUE_LEN>* _queues[WORK_CLASSES]; // work queues - nullptr until made
+    static rtos::Thread* _threads[WORK_CLASSES];    // worker threads - nullptr until made
+    static volatile uint8_t _state;                 // queue and thread construction state
+    static workStats_t _stats[WORK_CLASSES];        // statistics
+    static uint32_t _clientStack;                   // total stack size declared by clients
+    static uint16_t _clientCount;                   // number of clients
+
+    static void _dispatch(WorkClass_t, work_t*);            // record latency and run work item
+    static void _run(rtos::Mail<work_t, WORK_QUEUE_LEN>*);  // worker thread
+    static void _make();                                    // construct queues and threads if not made
+};
+
+#endif /* defined(____dawsWorkerPool__) */